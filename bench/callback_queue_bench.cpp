@@ -0,0 +1,118 @@
+//
+//  callback_queue_bench.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "callback_queue.hpp"
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Measures how fast N producer threads can post callbacks to a single
+// consumer, as set_immediate() does from worker threads. The lock-free
+// queue is compared against the mutex and vector that set_immediate()
+// used before.
+
+struct MutexQueue {
+    std::mutex mutex;
+    std::vector<std::function<void()>> callbacks;
+
+    void push(std::function<void()> callback) {
+        mutex.lock();
+        callbacks.push_back(std::move(callback));
+        mutex.unlock();
+    }
+
+    void drain(std::vector<std::function<void()>>* out) {
+        mutex.lock();
+        std::swap(callbacks, *out);
+        mutex.unlock();
+    }
+};
+
+static double run_lock_free(int num_producers, int callbacks_per_producer) {
+    CallbackQueue queue;
+    long long counter = 0;
+    long long total = (long long)num_producers * callbacks_per_producer;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < num_producers; ++i) {
+        producers.emplace_back([&]() {
+            for (int j = 0; j < callbacks_per_producer; ++j) {
+                queue.push([&counter]() { ++counter; });
+            }
+        });
+    }
+
+    std::function<void()> callback;
+    while (counter < total) {
+        while (queue.pop(&callback)) {
+            callback();
+        }
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+static double run_mutex(int num_producers, int callbacks_per_producer) {
+    MutexQueue queue;
+    long long counter = 0;
+    long long total = (long long)num_producers * callbacks_per_producer;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < num_producers; ++i) {
+        producers.emplace_back([&]() {
+            for (int j = 0; j < callbacks_per_producer; ++j) {
+                queue.push([&counter]() { ++counter; });
+            }
+        });
+    }
+
+    std::vector<std::function<void()>> callbacks;
+    while (counter < total) {
+        queue.drain(&callbacks);
+        for (auto& callback : callbacks) {
+            callback();
+        }
+        callbacks.clear();
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main(int argc, char** argv) {
+    int callbacks_per_producer = argc > 1 ? atoi(argv[1]) : 200000;
+    int max_producers = argc > 2 ? atoi(argv[2]) : 8;
+
+    printf("%10s %18s %18s\n", "producers", "lock-free (M/s)", "mutex (M/s)");
+    for (int num_producers = 1; num_producers <= max_producers; num_producers *= 2) {
+        auto total = (double)num_producers * callbacks_per_producer;
+        auto lock_free_time = run_lock_free(num_producers, callbacks_per_producer);
+        auto mutex_time = run_mutex(num_producers, callbacks_per_producer);
+        printf("%10d %18.2f %18.2f\n", num_producers,
+               total / lock_free_time * 1e-6,
+               total / mutex_time * 1e-6);
+    }
+
+    return 0;
+}
@@ -0,0 +1,442 @@
+//
+//  ddui_bench.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include <ddui/core>
+#include <ddui/views/VirtualizedList>
+#include <ddui/views/ScrollArea>
+#include <ddui/views/TextView>
+#include <ddui/views/PlainTextBox>
+#include <ddui/views/Menu>
+#include <ddui/views/TokenizedContent>
+#include <ddui/views/TabBar>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Drives scripted scenes through ddui on a headless backend, and reports
+// the CPU time, allocations and render stats of their frames as JSON:
+//
+//     ddui_bench [--frames N] [--scene NAME] > results.json
+//
+// Every scene starts with warm-up frames that aren't measured, so the
+// numbers are of steady state. Allocations are counted through the
+// global operator new, so they cover C++ allocations on all threads.
+
+static std::atomic<long> num_allocations;
+
+void* operator new(size_t size) {
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto ptr = malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+using namespace ddui;
+
+constexpr float WIDTH = 1280;
+constexpr float HEIGHT = 800;
+constexpr int NUM_WARM_UP_FRAMES = 10;
+
+static double get_cpu_time() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static void click(float x, float y) {
+    input_mouse_position(x, y);
+    input_mouse_button(0, keyboard::ACTION_PRESS, 0);
+    input_mouse_button(0, keyboard::ACTION_RELEASE, 0);
+}
+
+struct Scene {
+    virtual ~Scene() = default;
+    virtual const char* name() = 0;
+
+    // Called before each of the scene's num_frames frames, warm-up
+    // included, to feed input and change the content
+    virtual void step(int frame, int num_frames) = 0;
+    virtual void update() = 0;
+};
+
+// 100k rows, scrolled down and back up
+struct VirtualizedListScene : Scene {
+    VirtualizedList::State state;
+
+    const char* name() override { return "virtualized_list_scroll"; }
+
+    void step(int frame, int num_frames) override {
+        input_mouse_position(WIDTH / 2, HEIGHT / 2);
+        input_scroll(0, frame < num_frames / 2 ? -5 : 5);
+    }
+
+    void update() override {
+        char label[32];
+        VirtualizedList::update(&state, 100000, [](int index) {
+            return 24.0f;
+        }, [&](int index) {
+            snprintf(label, sizeof(label), "Row %d", index);
+            font_face("regular");
+            font_size(16);
+            fill_color(rgb(0x000000));
+            text(8, 17, label, NULL);
+        }, []() {});
+    }
+};
+
+// A 1 MB document, with a character typed into the middle of it every frame
+struct TextViewScene : Scene {
+    TextView::Model model;
+    TextView::State state;
+    ScrollArea::ScrollAreaState scroll_area;
+
+    TextViewScene() {
+        std::string content;
+        content.reserve(1 << 20);
+        char line[128];
+        for (int i = 0; content.size() < (1 << 20); ++i) {
+            snprintf(line, sizeof(line), "%d. The quick brown fox jumps over the lazy dog, again and again.\n", i);
+            content += line;
+        }
+        TextEdit::set_text_content(&model, content.c_str());
+    }
+
+    const char* name() override { return "text_view_edit"; }
+
+    void step(int frame, int num_frames) override {
+        auto line = (int)model.lines.size() / 2;
+        TextEdit::insert_character(&model, line, frame % 40, "x");
+        model.version_count++;
+        repaint("ddui_bench");
+    }
+
+    void update() override {
+        auto margin = TextView::get_global_styles()->margin;
+        auto width = state.measurements.width + 2 * margin;
+        auto height = state.measurements.height + 2 * margin;
+        ScrollArea::update(&scroll_area, std::max(width, view.width), std::max(height, view.height), [&]() {
+            TextView(&state, &model).update();
+        });
+    }
+};
+
+// 500 text boxes in a grid, with the mouse going over them and clicking
+struct PlainTextBoxScene : Scene {
+    static constexpr int COLUMNS = 20;
+    static constexpr int ROWS = 25;
+    std::unique_ptr<PlainTextBox::Model[]> models;
+    std::unique_ptr<PlainTextBox::State[]> states;
+
+    PlainTextBoxScene() : models(new PlainTextBox::Model[COLUMNS * ROWS]), states(new PlainTextBox::State[COLUMNS * ROWS]) {
+        char content[32];
+        for (int i = 0; i < COLUMNS * ROWS; ++i) {
+            snprintf(content, sizeof(content), "Box %d", i);
+            TextEdit::set_text_content(&models[i], content);
+        }
+    }
+
+    const char* name() override { return "plain_text_boxes"; }
+
+    void step(int frame, int num_frames) override {
+        auto index = (frame * 7) % (COLUMNS * ROWS);
+        auto x = (index % COLUMNS + 0.5f) * (WIDTH / COLUMNS);
+        auto y = (index / COLUMNS + 0.5f) * (HEIGHT / ROWS);
+        if (frame % 25 == 0) {
+            click(x, y);
+        } else {
+            input_mouse_position(x, y);
+        }
+    }
+
+    void update() override {
+        auto box_width = WIDTH / COLUMNS;
+        auto box_height = HEIGHT / ROWS;
+        for (int i = 0; i < COLUMNS * ROWS; ++i) {
+            sub_view((i % COLUMNS) * box_width + 2, (i / COLUMNS) * box_height + 2, box_width - 4, box_height - 4);
+            PlainTextBox(&states[i], &models[i]).update();
+            restore();
+        }
+    }
+};
+
+// A menu of 1000 items, every 50th with a sub-menu, with the mouse going down it
+struct MenuScene : Scene {
+    Menu::State state;
+
+    MenuScene() {
+        MenuBuilder builder;
+        auto root = builder.menu();
+        char text[32];
+        for (int i = 0; i < 1000; ++i) {
+            snprintf(text, sizeof(text), "Item %d", i);
+            root.item(text).action(i + 1);
+            if (i % 50 == 0) {
+                auto sub_menu = builder.menu();
+                for (int j = 0; j < 20; ++j) {
+                    snprintf(text, sizeof(text), "Sub-item %d.%d", i, j);
+                    sub_menu.item(text).action(1000 + i * 20 + j);
+                }
+                root.sub_menu(sub_menu);
+            }
+        }
+        state = builder.create(root, 20, 20);
+    }
+
+    const char* name() override { return "menu_1000_items"; }
+
+    void step(int frame, int num_frames) override {
+        input_mouse_position(60, 30 + (frame * 3) % (int)(HEIGHT - 60));
+    }
+
+    void update() override {
+        Menu::Action action;
+        Menu(state).process_user_input(&action).render();
+    }
+};
+
+// 10k words of text, laid out again every frame while being scrolled
+struct TokenizedContentScene : Scene {
+    TokenizedContent::State state;
+    ScrollArea::ScrollAreaState scroll_area;
+
+    TokenizedContentScene() {
+        TokenizedContent::set_font_settings(&state, rgb(0x000000), 16, "regular");
+        std::string content;
+        char word[32];
+        for (int i = 0; i < 10000; ++i) {
+            snprintf(word, sizeof(word), i % 97 == 96 ? "word%d\n" : "word%d ", i);
+            content += word;
+        }
+        TokenizedContent::tokenize_and_append_text(&state, std::move(content));
+    }
+
+    const char* name() override { return "tokenized_content_10k"; }
+
+    void step(int frame, int num_frames) override {
+        input_mouse_position(WIDTH / 2, HEIGHT / 2);
+        input_scroll(0, frame < num_frames / 2 ? -5 : 5);
+    }
+
+    void update() override {
+        auto width = view.width - 20;
+        auto height = TokenizedContent::measure_content_height(&state, width);
+        ScrollArea::update(&scroll_area, width, height, [&]() {
+            TokenizedContent::update(&state);
+        });
+    }
+};
+
+// 200 tabs, with the mouse going over them and switching tabs
+struct TabBarScene : Scene {
+    TabBar::State state;
+    std::vector<std::string> tab_names;
+    int active_tab = 0;
+
+    TabBarScene() {
+        char name[32];
+        for (int i = 0; i < 200; ++i) {
+            snprintf(name, sizeof(name), "Tab %d", i);
+            tab_names.push_back(name);
+        }
+    }
+
+    const char* name() override { return "tab_bar_200"; }
+
+    void step(int frame, int num_frames) override {
+        auto x = (frame * 13) % (int)WIDTH + 0.5f;
+        if (frame % 20 == 0) {
+            click(x, 20);
+        } else {
+            input_mouse_position(x, 20);
+        }
+    }
+
+    void update() override {
+        sub_view(0, 0, view.width, 40);
+        TabBar::Action action;
+        TabBar(state).render(tab_names, active_tab).process_action(&action);
+        if (action.type == TabBar::SWITCH_TO_TAB) {
+            active_tab = action.tab_index;
+        }
+        restore();
+    }
+};
+
+struct Summary {
+    double mean, p50, p95, p99, max;
+};
+
+static Summary summarize(std::vector<double>& values) {
+    Summary summary = { 0 };
+    if (values.empty()) {
+        return summary;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (auto value : values) {
+        sum += value;
+    }
+    auto percentile = [&](double p) {
+        auto index = (size_t)std::max(0.0, p * values.size() - 1);
+        return values[std::min(index, values.size() - 1)];
+    };
+    summary.mean = sum / values.size();
+    summary.p50 = percentile(0.50);
+    summary.p95 = percentile(0.95);
+    summary.p99 = percentile(0.99);
+    summary.max = values.back();
+    return summary;
+}
+
+static void print_summary(const char* name, const Summary& summary, const char* suffix) {
+    printf("      \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+           name, summary.mean, summary.p50, summary.p95, summary.p99, summary.max, suffix);
+}
+
+static void run_scene(Scene* scene, int num_frames, bool is_last) {
+    for (int frame = 0; frame < NUM_WARM_UP_FRAMES; ++frame) {
+        scene->step(frame, NUM_WARM_UP_FRAMES + num_frames);
+        update(WIDTH, HEIGHT, 1.0, [&]() { scene->update(); });
+    }
+
+    std::vector<double> cpu_ms, allocations;
+    std::vector<double> calls, vertices, uniform_bytes, texture_bytes;
+    std::vector<double> convex_fills, stencil_fills, glyph_misses, passes;
+    for (auto values : { &cpu_ms, &allocations, &calls, &vertices, &uniform_bytes,
+                         &texture_bytes, &convex_fills, &stencil_fills, &glyph_misses, &passes }) {
+        values->reserve(num_frames);
+    }
+
+    auto start_text_cache_stats = get_text_measurement_cache_stats();
+    auto start_font_atlas_stats = get_font_atlas_stats();
+    for (int frame = 0; frame < num_frames; ++frame) {
+        scene->step(NUM_WARM_UP_FRAMES + frame, NUM_WARM_UP_FRAMES + num_frames);
+
+        auto start_allocations = num_allocations.load();
+        auto start_time = get_cpu_time();
+        update(WIDTH, HEIGHT, 1.0, [&]() { scene->update(); });
+        auto time = get_cpu_time() - start_time;
+        auto frame_allocations = num_allocations.load() - start_allocations;
+
+        auto& stats = get_render_stats();
+        cpu_ms.push_back(time * 1000.0);
+        allocations.push_back((double)frame_allocations);
+        calls.push_back(stats.num_calls);
+        vertices.push_back(stats.num_vertices);
+        uniform_bytes.push_back(stats.uniform_bytes);
+        texture_bytes.push_back(stats.texture_bytes);
+        convex_fills.push_back(stats.num_convex_fills);
+        stencil_fills.push_back(stats.num_stencil_fills);
+        glyph_misses.push_back(stats.num_glyph_misses);
+        passes.push_back(stats.num_passes);
+    }
+
+    auto& text_cache_stats = get_text_measurement_cache_stats();
+    auto text_cache_hits = text_cache_stats.num_hits - start_text_cache_stats.num_hits;
+    auto text_cache_misses = text_cache_stats.num_misses - start_text_cache_stats.num_misses;
+    auto text_cache_lookups = text_cache_hits + text_cache_misses;
+    auto& font_atlas_stats = get_font_atlas_stats();
+
+    printf("    {\n");
+    printf("      \"name\": \"%s\",\n", scene->name());
+    printf("      \"frames\": %d,\n", num_frames);
+    print_summary("cpu_ms", summarize(cpu_ms), ",");
+    print_summary("allocations", summarize(allocations), ",");
+    print_summary("calls", summarize(calls), ",");
+    print_summary("vertices", summarize(vertices), ",");
+    print_summary("uniform_bytes", summarize(uniform_bytes), ",");
+    print_summary("texture_bytes", summarize(texture_bytes), ",");
+    print_summary("convex_fills", summarize(convex_fills), ",");
+    print_summary("stencil_fills", summarize(stencil_fills), ",");
+    print_summary("glyph_misses", summarize(glyph_misses), ",");
+    print_summary("passes", summarize(passes), ",");
+    printf("      \"text_measurement_cache\": { \"hits\": %ld, \"misses\": %ld, \"hit_rate\": %.4f },\n",
+           text_cache_hits, text_cache_misses,
+           text_cache_lookups > 0 ? (double)text_cache_hits / text_cache_lookups : 0.0);
+    printf("      \"font_atlas\": { \"pages\": %d, \"bytes\": %d, \"evicted_glyphs\": %d, \"evicted_pages\": %d }\n",
+           font_atlas_stats.num_pages, font_atlas_stats.num_bytes,
+           font_atlas_stats.num_evicted_glyphs - start_font_atlas_stats.num_evicted_glyphs,
+           font_atlas_stats.num_evicted_pages - start_font_atlas_stats.num_evicted_pages);
+    printf("    }%s\n", is_last ? "" : ",");
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    int num_frames = 120;
+    const char* only_scene = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            num_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            only_scene = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--frames N] [--scene NAME]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    set_post_empty_message_proc([]() {});
+    if (!init()) {
+        fprintf(stderr, "ddui_bench: couldn't initialize ddui\n");
+        return 1;
+    }
+    create_font("regular", "bench.ttf");
+    create_font("bold", "bench.ttf");
+
+    std::vector<std::function<Scene*()>> constructors = {
+        []() -> Scene* { return new VirtualizedListScene(); },
+        []() -> Scene* { return new TextViewScene(); },
+        []() -> Scene* { return new PlainTextBoxScene(); },
+        []() -> Scene* { return new MenuScene(); },
+        []() -> Scene* { return new TokenizedContentScene(); },
+        []() -> Scene* { return new TabBarScene(); }
+    };
+
+    std::vector<std::unique_ptr<Scene>> scenes;
+    for (auto& construct : constructors) {
+        std::unique_ptr<Scene> scene(construct());
+        if (!only_scene || strcmp(only_scene, scene->name()) == 0) {
+            scenes.push_back(std::move(scene));
+        }
+    }
+    if (scenes.empty()) {
+        fprintf(stderr, "ddui_bench: no scene named %s\n", only_scene);
+        return 1;
+    }
+
+    printf("{\n");
+    printf("  \"frames_per_scene\": %d,\n", num_frames);
+    printf("  \"width\": %d,\n", (int)WIDTH);
+    printf("  \"height\": %d,\n", (int)HEIGHT);
+    printf("  \"scenes\": [\n");
+    for (int i = 0; i < scenes.size(); ++i) {
+        run_scene(scenes[i].get(), num_frames, i == scenes.size() - 1);
+    }
+    printf("  ]\n");
+    printf("}\n");
+
+    terminate();
+    return 0;
+}
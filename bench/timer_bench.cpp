@@ -0,0 +1,85 @@
+//
+//  timer_bench.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include <ddui/core>
+#include "timer.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Microbenchmark of ddui::timer with many active timers: the cost of
+// scheduling and clearing them, and the CPU time the timer thread spends
+// dispatching them when they come due.
+
+static std::atomic<int> num_dispatched;
+
+static double seconds_since(std::chrono::high_resolution_clock::time_point start_time) {
+    auto end_time = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main(int argc, char** argv) {
+    int num_timers = argc > 1 ? atoi(argv[1]) : 100000;
+
+    // Each wake-up of the timer thread posts a set_immediate,
+    // which ends up here as nothing is painting
+    ddui::set_post_empty_message_proc([]() {
+        num_dispatched += 1;
+    });
+    timer_init();
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<long> far_away(60000, 120000);
+
+    // Schedule timers that won't come due during the benchmark
+    std::vector<int> ids(num_timers);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_timers; ++i) {
+        ids[i] = ddui::timer::set_timeout([]() {}, far_away(rng));
+    }
+    auto schedule_time = seconds_since(start_time);
+
+    // Clear them in random order
+    std::shuffle(ids.begin(), ids.end(), rng);
+    start_time = std::chrono::high_resolution_clock::now();
+    for (auto id : ids) {
+        ddui::timer::clear_timeout(id);
+    }
+    auto clear_time = seconds_since(start_time);
+
+    // Keep all the timers active, and let a slice of them come due over
+    // half a second, so the thread wakes up many times with a full store
+    std::uniform_int_distribution<long> soon(1, 500);
+    for (int i = 0; i < num_timers; ++i) {
+        ids[i] = ddui::timer::set_timeout([]() {}, far_away(rng));
+    }
+    int num_due = num_timers / 10;
+    num_dispatched = 0;
+    auto cpu_start = clock();
+    start_time = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_due; ++i) {
+        ddui::timer::set_timeout([]() {}, soon(rng));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    auto dispatch_time = seconds_since(start_time);
+    auto dispatch_cpu_time = (double)(clock() - cpu_start) / CLOCKS_PER_SEC;
+
+    printf("active timers:     %d\n", num_timers);
+    printf("set_timeout:       %.1f ns/op\n", schedule_time / num_timers * 1e9);
+    printf("clear_timeout:     %.1f ns/op\n", clear_time / num_timers * 1e9);
+    printf("dispatch:          %d timers over %.3f s, %.3f s of CPU, %d wake-ups\n",
+           num_due, dispatch_time, dispatch_cpu_time, (int)num_dispatched);
+
+    return 0;
+}
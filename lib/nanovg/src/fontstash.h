@@ -21,6 +21,10 @@
 
 #define FONS_INVALID -1
 
+#ifndef FONS_MAX_PAGES
+#	define FONS_MAX_PAGES 64
+#endif
+
 enum FONSflags {
 	FONS_ZERO_TOPLEFT = 1,
 	FONS_ZERO_BOTTOMLEFT = 2,
@@ -70,6 +74,7 @@ struct FONSquad
 {
 	float x0,y0,s0,t0;
 	float x1,y1,s1,t1;
+	int page;
 };
 typedef struct FONSquad FONSquad;
 
@@ -79,6 +84,8 @@ struct FONStextIter {
 	short isize, iblur;
 	struct FONSfont* font;
 	int prevGlyphIndex;
+	int cacheIndex;
+	int pending;
 	const char* str;
 	const char* next;
 	const char* end;
@@ -87,6 +94,20 @@ struct FONStextIter {
 };
 typedef struct FONStextIter FONStextIter;
 
+struct FONSatlasStats {
+	int npages;
+	int maxPages;
+	int pageWidth, pageHeight;
+	int nglyphs;
+	int nevictedGlyphs;
+	int nevictedPages;
+	int nglyphMisses;
+	int npendingGlyphs;
+};
+typedef struct FONSatlasStats FONSatlasStats;
+
+typedef struct FONSglyphJob FONSglyphJob;
+
 typedef struct FONScontext FONScontext;
 
 // Constructor and destructor.
@@ -94,13 +115,57 @@ FONScontext* fonsCreateInternal(FONSparams* params);
 void fonsDeleteInternal(FONScontext* s);
 
 void fonsSetErrorCallback(FONScontext* s, void (*callback)(void* uptr, int error, int val), void* uptr);
-// Returns current atlas size.
+// Returns current atlas page size.
 void fonsGetAtlasSize(FONScontext* s, int* width, int* height);
-// Expands the atlas size.
+// Expands the size of every atlas page.
 int fonsExpandAtlas(FONScontext* s, int width, int height);
-// Resets the whole stash.
+// Resets the whole stash, leaving a single page.
 int fonsResetAtlas(FONScontext* stash, int width, int height);
 
+// The atlas is made of pages of the same size. Glyphs are added to the
+// pages there are, then to a new page while there are fewer than the
+// maximum, and then to the coldest page that hasn't been used since
+// fonsBeginFrame(), whose glyphs are evicted and rasterized again when
+// next drawn. If every page has been used this frame, a page is added
+// beyond the maximum, which fonsTrimPages() takes away again once the
+// frame has been drawn.
+void fonsSetMaxPages(FONScontext* s, int maxPages);
+void fonsBeginFrame(FONScontext* s);
+void fonsTrimPages(FONScontext* s);
+// Marks glyphs as drawn this frame, by the cacheIndex the text iterator
+// gave them, for callers that keep quads instead of iterating again.
+void fonsTouchGlyphs(FONScontext* s, int font, const int* cacheIndices, int count);
+// Marks a page as drawn this frame, for callers that keep vertices.
+void fonsTouchPage(FONScontext* s, int page);
+void fonsGetAtlasStats(FONScontext* s, FONSatlasStats* stats);
+
+// Glyphs can be rasterized away from the thread that draws text. Once a
+// callback is set, a glyph that has to be rasterized gets its place in the
+// atlas right away and is handed to the callback as a job, and the text
+// iterator marks it as pending. Until the job is finished, the glyph is
+// drawn from the same glyph at the nearest other size, or not at all.
+// Only stb_truetype fonts can be rasterized this way.
+void fonsSetGlyphJobCallback(FONScontext* s, void (*callback)(void* uptr, FONSglyphJob* job), void* uptr);
+// Rasterizes the glyph of a job. Can be called on any thread.
+void fonsRasterizeGlyphJob(FONSglyphJob* job);
+// Returns the bytes the glyph of a job takes in the atlas.
+int fonsGlyphJobSize(FONSglyphJob* job);
+// Copies the glyph of a rasterized job into the atlas, and frees the job.
+// Returns 0 if the glyph was evicted in the meantime. Every job has to be
+// finished before the stash is deleted.
+int fonsFinishGlyphJob(FONScontext* s, FONSglyphJob* job);
+
+// The atlas can be saved and loaded back, so that glyphs don't have to be
+// rasterized again in the next run. The data holds the pages, and the
+// glyphs on them by font, keyed by a hash of the font data. Loading only
+// works while the atlas has no glyphs yet, and only restores the glyphs
+// of fonts that have been added with the same data, up to the maximum
+// number of pages. Data is only meant to be loaded on the same machine.
+// Returns the data, to be freed with free(), or NULL.
+unsigned char* fonsSaveAtlas(FONScontext* s, int* size);
+// Returns the number of glyphs restored.
+int fonsLoadAtlas(FONScontext* s, const unsigned char* data, int size);
+
 // Add fonts
 int fonsAddFont(FONScontext* s, const char* name, const char* path, int fontIndex);
 int fonsAddFontMem(FONScontext* s, const char* name, unsigned char* data, int ndata, int freeData, int fontIndex);
@@ -131,9 +196,12 @@ void fonsVertMetrics(FONScontext* s, float* ascender, float* descender, float* l
 int fonsTextIterInit(FONScontext* stash, FONStextIter* iter, float x, float y, const char* str, const char* end, int bitmapOption);
 int fonsTextIterNext(FONScontext* stash, FONStextIter* iter, struct FONSquad* quad);
 
-// Pull texture changes
-const unsigned char* fonsGetTextureData(FONScontext* stash, int* width, int* height);
-int fonsValidateTexture(FONScontext* s, int* dirty);
+// Pull texture changes. Pages that don't exist have no texture data.
+const unsigned char* fonsGetTextureData(FONScontext* stash, int page, int* width, int* height);
+int fonsValidateTexture(FONScontext* s, int page, int* dirty);
+
+// Returns the number of glyph lookups so far that missed the cache
+int fonsGetGlyphMissCount(FONScontext* s);
 
 // Draws the stash texture for debugging
 void fonsDrawDebug(FONScontext* s, float x, float y);
@@ -354,6 +422,9 @@ int fons__tt_getGlyphKernAdvance(FONSttFontImpl *font, int glyph1, int glyph2)
 #ifndef FONS_MAX_FALLBACKS
 #	define FONS_MAX_FALLBACKS 20
 #endif
+#ifndef FONS_HOT_FRAMES
+#	define FONS_HOT_FRAMES 60
+#endif
 
 static unsigned int fons__hashint(unsigned int a)
 {
@@ -384,6 +455,9 @@ struct FONSglyph
 	short size, blur;
 	short x0,y0,x1,y1;
 	short xadv,xoff,yoff;
+	short page;
+	short pending;
+	int lastUsed;
 };
 typedef struct FONSglyph FONSglyph;
 
@@ -403,6 +477,7 @@ struct FONSfont
 	int lut[FONS_HASH_LUT_SIZE];
 	int fallbacks[FONS_MAX_FALLBACKS];
 	int nfallbacks;
+	unsigned int hash[2];
 };
 typedef struct FONSfont FONSfont;
 
@@ -431,14 +506,83 @@ struct FONSatlas
 };
 typedef struct FONSatlas FONSatlas;
 
+// A page exists while it has an atlas
+struct FONSpage
+{
+	FONSatlas* atlas;
+	unsigned char* texData;
+	int dirtyRect[4];
+	int lastUsed;
+	int nglyphs;
+	int generation;
+};
+typedef struct FONSpage FONSpage;
+
+// A glyph to rasterize, and where it goes in the atlas
+struct FONSglyphJob
+{
+	FONSttFontImpl font;
+	int glyphIndex;
+	float scale;
+	int width, height, pad, blur;
+	FONSfont* target;
+	int cacheIndex;
+	int page, pageGeneration;
+	int x, y;
+	unsigned char* bitmap;
+};
+
+// Saved atlas data: the header, then for every page its skyline nodes and
+// texture data, then for every font its hash and its glyphs. Pages are
+// numbered in the order they were saved.
+#ifdef FONS_USE_FREETYPE
+#	define FONS_ATLAS_MAGIC 0x464e4f46 // "FONF"
+#else
+#	define FONS_ATLAS_MAGIC 0x534e4f46 // "FONS"
+#endif
+#define FONS_ATLAS_VERSION 1
+
+struct FONSsavedAtlas
+{
+	int magic, version;
+	int width, height;
+	int npages, nfonts;
+};
+typedef struct FONSsavedAtlas FONSsavedAtlas;
+
+struct FONSsavedFont
+{
+	unsigned int hash[2];
+	int nglyphs;
+};
+typedef struct FONSsavedFont FONSsavedFont;
+
+struct FONSsavedGlyph
+{
+	unsigned int codepoint;
+	int index;
+	short size, blur;
+	short x0,y0,x1,y1;
+	short xadv,xoff,yoff;
+	short page;
+};
+typedef struct FONSsavedGlyph FONSsavedGlyph;
+
 struct FONScontext
 {
 	FONSparams params;
 	float itw,ith;
-	unsigned char* texData;
-	int dirtyRect[4];
+	FONSpage pages[FONS_MAX_PAGES];
+	int npages;
+	int maxPages;
+	int frame;
+	int nevictedGlyphs;
+	int nevictedPages;
+	int pageGenerations;
+	void (*glyphJobCallback)(void* uptr, FONSglyphJob* job);
+	void* glyphJobUptr;
+	int npendingGlyphs;
 	FONSfont** fonts;
-	FONSatlas* atlas;
 	int cfonts;
 	int nfonts;
 	float verts[FONS_VERTEX_COUNT*2];
@@ -449,6 +593,7 @@ struct FONScontext
 	int nscratch;
 	FONSstate states[FONS_MAX_STATES];
 	int nstates;
+	int nglyphMisses;
 	void (*handleError)(void* uptr, int error, int val);
 	void* errorUptr;
 };
@@ -460,6 +605,10 @@ static void* fons__tmpalloc(size_t size, void* up)
 	unsigned char* ptr;
 	FONScontext* stash = (FONScontext*)up;
 
+	// Glyph jobs are rasterized without a stash
+	if (stash == NULL)
+		return malloc(size);
+
 	// 16-byte align the returned pointer
 	size = (size + 0xf) & ~0xf;
 
@@ -475,9 +624,9 @@ static void* fons__tmpalloc(size_t size, void* up)
 
 static void fons__tmpfree(void* ptr, void* up)
 {
-	(void)ptr;
-	(void)up;
-	// empty
+	// empty, unless allocated for a glyph job
+	if (up == NULL)
+		free(ptr);
 }
 
 #endif // STB_TRUETYPE_IMPLEMENTATION
@@ -703,25 +852,192 @@ static int fons__atlasAddRect(FONSatlas* atlas, int rw, int rh, int* rx, int* ry
 	return 1;
 }
 
+static void fons__addDirtyRect(FONSpage* page, int x0, int y0, int x1, int y1)
+{
+	page->dirtyRect[0] = fons__mini(page->dirtyRect[0], x0);
+	page->dirtyRect[1] = fons__mini(page->dirtyRect[1], y0);
+	page->dirtyRect[2] = fons__maxi(page->dirtyRect[2], x1);
+	page->dirtyRect[3] = fons__maxi(page->dirtyRect[3], y1);
+}
+
+static void fons__resetDirtyRect(FONScontext* stash, FONSpage* page)
+{
+	page->dirtyRect[0] = stash->params.width;
+	page->dirtyRect[1] = stash->params.height;
+	page->dirtyRect[2] = 0;
+	page->dirtyRect[3] = 0;
+}
+
 static void fons__addWhiteRect(FONScontext* stash, int w, int h)
 {
 	int x, y, gx, gy;
 	unsigned char* dst;
-	if (fons__atlasAddRect(stash->atlas, w, h, &gx, &gy) == 0)
+	FONSpage* page = &stash->pages[0];
+	if (fons__atlasAddRect(page->atlas, w, h, &gx, &gy) == 0)
 		return;
 
 	// Rasterize
-	dst = &stash->texData[gx + gy * stash->params.width];
+	dst = &page->texData[gx + gy * stash->params.width];
 	for (y = 0; y < h; y++) {
 		for (x = 0; x < w; x++)
 			dst[x] = 0xff;
 		dst += stash->params.width;
 	}
 
-	stash->dirtyRect[0] = fons__mini(stash->dirtyRect[0], gx);
-	stash->dirtyRect[1] = fons__mini(stash->dirtyRect[1], gy);
-	stash->dirtyRect[2] = fons__maxi(stash->dirtyRect[2], gx+w);
-	stash->dirtyRect[3] = fons__maxi(stash->dirtyRect[3], gy+h);
+	fons__addDirtyRect(page, gx, gy, gx+w, gy+h);
+}
+
+// Empties a page, which the white rect for debug drawing goes back into
+// if it is the first page.
+static void fons__clearPage(FONScontext* stash, int i)
+{
+	FONSpage* page = &stash->pages[i];
+	fons__atlasReset(page->atlas, stash->params.width, stash->params.height);
+	memset(page->texData, 0, stash->params.width * stash->params.height);
+	fons__resetDirtyRect(stash, page);
+	page->lastUsed = stash->frame;
+	page->nglyphs = 0;
+	page->generation = ++stash->pageGenerations;
+	if (i == 0)
+		fons__addWhiteRect(stash, 2,2);
+}
+
+static int fons__addPage(FONScontext* stash)
+{
+	FONSpage* page;
+	int i;
+
+	for (i = 0; i < FONS_MAX_PAGES; i++) {
+		if (stash->pages[i].atlas == NULL)
+			break;
+	}
+	if (i == FONS_MAX_PAGES) return -1;
+
+	page = &stash->pages[i];
+	page->atlas = fons__allocAtlas(stash->params.width, stash->params.height, FONS_INIT_ATLAS_NODES);
+	if (page->atlas == NULL) return -1;
+	page->texData = (unsigned char*)malloc(stash->params.width * stash->params.height);
+	if (page->texData == NULL) {
+		fons__deleteAtlas(page->atlas);
+		page->atlas = NULL;
+		return -1;
+	}
+	stash->npages++;
+	fons__clearPage(stash, i);
+	return i;
+}
+
+static void fons__freePage(FONScontext* stash, int i)
+{
+	FONSpage* page = &stash->pages[i];
+	if (page->atlas == NULL) return;
+	fons__deleteAtlas(page->atlas);
+	free(page->texData);
+	memset(page, 0, sizeof(FONSpage));
+	stash->npages--;
+}
+
+// Drops the bitmaps of the glyphs on a page. The glyphs keep their size,
+// so that they can still be measured, and are rasterized again when drawn.
+static void fons__evictPage(FONScontext* stash, int i)
+{
+	int j, k;
+	for (j = 0; j < stash->nfonts; j++) {
+		FONSfont* font = stash->fonts[j];
+		for (k = 0; k < font->nglyphs; k++) {
+			FONSglyph* glyph = &font->glyphs[k];
+			if (glyph->page != i || glyph->x0 < 0)
+				continue;
+			glyph->x1 = (short)(glyph->x1 - glyph->x0 - 1);
+			glyph->y1 = (short)(glyph->y1 - glyph->y0 - 1);
+			glyph->x0 = -1;
+			glyph->y0 = -1;
+			glyph->page = -1;
+			glyph->pending = 0;
+			stash->nevictedGlyphs++;
+		}
+	}
+	stash->nevictedPages++;
+}
+
+// Returns the page to evict: out of the pages that haven't been used this
+// frame, the one with the fewest glyphs drawn in the last FONS_HOT_FRAMES
+// frames, and then the one used longest ago. At the end of a frame pages
+// used in it can go too, except for the first, which is never freed, and
+// the fewest glyphs drawn in the frame itself count first: otherwise the
+// page that was just added for the frame would go, and be added back in
+// the next one.
+static int fons__findColdestPage(FONScontext* stash, int endOfFrame)
+{
+	int current[FONS_MAX_PAGES], hot[FONS_MAX_PAGES];
+	int i, j, best = -1;
+
+	memset(current, 0, sizeof(current));
+	memset(hot, 0, sizeof(hot));
+	for (i = 0; i < stash->nfonts; i++) {
+		FONSfont* font = stash->fonts[i];
+		for (j = 0; j < font->nglyphs; j++) {
+			FONSglyph* glyph = &font->glyphs[j];
+			if (glyph->page < 0)
+				continue;
+			if (glyph->lastUsed >= stash->frame)
+				current[glyph->page]++;
+			if (glyph->lastUsed > stash->frame - FONS_HOT_FRAMES)
+				hot[glyph->page]++;
+		}
+	}
+
+	for (i = 0; i < FONS_MAX_PAGES; i++) {
+		FONSpage* page = &stash->pages[i];
+		if (page->atlas == NULL)
+			continue;
+		if (endOfFrame ? i == 0 : page->lastUsed >= stash->frame)
+			continue;
+		if (best == -1 || current[i] < current[best] ||
+			(current[i] == current[best] && (hot[i] < hot[best] ||
+			(hot[i] == hot[best] && page->lastUsed < stash->pages[best].lastUsed))))
+			best = i;
+	}
+	return best;
+}
+
+static int fons__addGlyphRect(FONScontext* stash, int gw, int gh, int* page, int* gx, int* gy)
+{
+	int i;
+
+	if (gw > stash->params.width || gh > stash->params.height)
+		return 0;
+
+	for (i = 0; i < FONS_MAX_PAGES; i++) {
+		if (stash->pages[i].atlas != NULL && fons__atlasAddRect(stash->pages[i].atlas, gw, gh, gx, gy)) {
+			*page = i;
+			return 1;
+		}
+	}
+
+	i = -1;
+	if (stash->npages < stash->maxPages)
+		i = fons__addPage(stash);
+	if (i == -1) {
+		i = fons__findColdestPage(stash, 0);
+		if (i != -1) {
+			fons__evictPage(stash, i);
+			fons__clearPage(stash, i);
+		}
+	}
+	if (i == -1)
+		i = fons__addPage(stash);
+	if (i == -1)
+		return 0;
+
+	*page = i;
+	return fons__atlasAddRect(stash->pages[i].atlas, gw, gh, gx, gy);
+}
+
+static void fons__touchGlyph(FONScontext* stash, FONSglyph* glyph)
+{
+	glyph->lastUsed = stash->frame;
+	stash->pages[glyph->page].lastUsed = stash->frame;
 }
 
 FONScontext* fonsCreateInternal(FONSparams* params)
@@ -747,9 +1063,6 @@ FONScontext* fonsCreateInternal(FONSparams* params)
 			goto error;
 	}
 
-	stash->atlas = fons__allocAtlas(stash->params.width, stash->params.height, FONS_INIT_ATLAS_NODES);
-	if (stash->atlas == NULL) goto error;
-
 	// Allocate space for fonts.
 	stash->fonts = (FONSfont**)malloc(sizeof(FONSfont*) * FONS_INIT_FONTS);
 	if (stash->fonts == NULL) goto error;
@@ -757,20 +1070,11 @@ FONScontext* fonsCreateInternal(FONSparams* params)
 	stash->cfonts = FONS_INIT_FONTS;
 	stash->nfonts = 0;
 
-	// Create texture for the cache.
+	// Create the first page, with a white rect at 0,0 for debug drawing.
 	stash->itw = 1.0f/stash->params.width;
 	stash->ith = 1.0f/stash->params.height;
-	stash->texData = (unsigned char*)malloc(stash->params.width * stash->params.height);
-	if (stash->texData == NULL) goto error;
-	memset(stash->texData, 0, stash->params.width * stash->params.height);
-
-	stash->dirtyRect[0] = stash->params.width;
-	stash->dirtyRect[1] = stash->params.height;
-	stash->dirtyRect[2] = 0;
-	stash->dirtyRect[3] = 0;
-
-	// Add white rect at 0,0 for debug drawing.
-	fons__addWhiteRect(stash, 2,2);
+	stash->maxPages = 1;
+	if (fons__addPage(stash) == -1) goto error;
 
 	fonsPushState(stash);
 	fonsClearState(stash);
@@ -934,6 +1238,18 @@ error:
 	return FONS_INVALID;
 }
 
+static void fons__hashFont(FONSfont* font, unsigned int* hash)
+{
+	unsigned long long h = 14695981039346656037ull;
+	int i;
+	for (i = 0; i < font->dataSize; i++) {
+		h ^= font->data[i];
+		h *= 1099511628211ull;
+	}
+	hash[0] = (unsigned int)h;
+	hash[1] = (unsigned int)(h >> 32);
+}
+
 int fonsAddFontMem(FONScontext* stash, const char* name, unsigned char* data, int dataSize, int freeData, int fontIndex)
 {
 	int i, ascent, descent, fh, lineGap;
@@ -957,6 +1273,9 @@ int fonsAddFontMem(FONScontext* stash, const char* name, unsigned char* data, in
 	font->data = data;
 	font->freeData = (unsigned char)freeData;
 
+	// Saved atlases key glyphs by the font data, so it is hashed once here.
+	fons__hashFont(font, font->hash);
+
 	// Init font
 	stash->nscratch = 0;
 	if (!fons__tt_loadFont(stash, &font->font, data, dataSize, fontIndex)) goto error;
@@ -1066,6 +1385,37 @@ static void fons__blur(FONScontext* stash, unsigned char* dst, int w, int h, int
 //	fons__blurcols(dst, w, h, dstStride, alpha);
 }
 
+#ifndef FONS_USE_FREETYPE
+static int fons__queueGlyphJob(FONScontext* stash, FONSfont* font, FONSglyph* glyph,
+							   FONSttFontImpl* renderFont, int g, float scale, int pad, int iblur)
+{
+	FONSglyphJob* job = (FONSglyphJob*)malloc(sizeof(FONSglyphJob));
+	if (job == NULL) return 0;
+
+	// The job allocates for itself, instead of from the scratch buffer
+	job->font = *renderFont;
+	job->font.font.userdata = NULL;
+	job->glyphIndex = g;
+	job->scale = scale;
+	job->width = glyph->x1 - glyph->x0;
+	job->height = glyph->y1 - glyph->y0;
+	job->pad = pad;
+	job->blur = iblur;
+	job->target = font;
+	job->cacheIndex = (int)(glyph - font->glyphs);
+	job->page = glyph->page;
+	job->pageGeneration = stash->pages[glyph->page].generation;
+	job->x = glyph->x0;
+	job->y = glyph->y0;
+	job->bitmap = NULL;
+
+	glyph->pending = 1;
+	stash->npendingGlyphs++;
+	stash->glyphJobCallback(stash->glyphJobUptr, job);
+	return 1;
+}
+#endif
+
 static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned int codepoint,
 								 short isize, short iblur, int bitmapOption)
 {
@@ -1074,9 +1424,10 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	FONSglyph* glyph = NULL;
 	unsigned int h;
 	float size = isize/10.0f;
-	int pad, added;
+	int pad, added, page = -1;
 	unsigned char* bdst;
 	unsigned char* dst;
+	unsigned char* texData;
 	FONSfont* renderFont = font;
 
 	if (isize < 2) return NULL;
@@ -1092,8 +1443,13 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	while (i != -1) {
 		if (font->glyphs[i].codepoint == codepoint && font->glyphs[i].size == isize && font->glyphs[i].blur == iblur) {
 			glyph = &font->glyphs[i];
-			if (bitmapOption == FONS_GLYPH_BITMAP_OPTIONAL || (glyph->x0 >= 0 && glyph->y0 >= 0)) {
-			  return glyph;
+			if (glyph->x0 >= 0 && glyph->y0 >= 0) {
+				if (bitmapOption == FONS_GLYPH_BITMAP_REQUIRED)
+					fons__touchGlyph(stash, glyph);
+				return glyph;
+			}
+			if (bitmapOption == FONS_GLYPH_BITMAP_OPTIONAL) {
+				return glyph;
 			}
 			// At this point, glyph exists but the bitmap data is not yet created.
 			break;
@@ -1102,6 +1458,7 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	}
 
 	// Create a new glyph or rasterize bitmap data for a cached glyph.
+	stash->nglyphMisses++;
 	g = fons__tt_getGlyphIndex(&font->font, codepoint);
 	// Try to find the glyph in fallback fonts.
 	if (g == 0) {
@@ -1125,11 +1482,11 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	// Determines the spot to draw glyph in the atlas.
 	if (bitmapOption == FONS_GLYPH_BITMAP_REQUIRED) {
 		// Find free spot for the rect in the atlas
-		added = fons__atlasAddRect(stash->atlas, gw, gh, &gx, &gy);
+		added = fons__addGlyphRect(stash, gw, gh, &page, &gx, &gy);
 		if (added == 0 && stash->handleError != NULL) {
 			// Atlas is full, let the user to resize the atlas (or not), and try again.
 			stash->handleError(stash->errorUptr, FONS_ATLAS_FULL, 0);
-			added = fons__atlasAddRect(stash->atlas, gw, gh, &gx, &gy);
+			added = fons__addGlyphRect(stash, gw, gh, &page, &gx, &gy);
 		}
 		if (added == 0) return NULL;
 	} else {
@@ -1145,6 +1502,7 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 		glyph->size = isize;
 		glyph->blur = iblur;
 		glyph->next = 0;
+		glyph->lastUsed = 0;
 
 		// Insert char to hash lookup.
 		glyph->next = font->lut[h];
@@ -1158,17 +1516,29 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	glyph->xadv = (short)(scale * advance * 10.0f);
 	glyph->xoff = (short)(x0 - pad);
 	glyph->yoff = (short)(y0 - pad);
+	glyph->page = (short)page;
+	glyph->pending = 0;
 
 	if (bitmapOption == FONS_GLYPH_BITMAP_OPTIONAL) {
 		return glyph;
 	}
 
+	stash->pages[page].nglyphs++;
+	fons__touchGlyph(stash, glyph);
+
+#ifndef FONS_USE_FREETYPE
+	// Leave the bitmap to a job, if there is a callback to take it
+	if (stash->glyphJobCallback != NULL && fons__queueGlyphJob(stash, font, glyph, &renderFont->font, g, scale, pad, iblur))
+		return glyph;
+#endif
+
 	// Rasterize
-	dst = &stash->texData[(glyph->x0+pad) + (glyph->y0+pad) * stash->params.width];
+	texData = stash->pages[page].texData;
+	dst = &texData[(glyph->x0+pad) + (glyph->y0+pad) * stash->params.width];
 	fons__tt_renderGlyphBitmap(&renderFont->font, dst, gw-pad*2,gh-pad*2, stash->params.width, scale, scale, g);
 
 	// Make sure there is one pixel empty border.
-	dst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
+	dst = &texData[glyph->x0 + glyph->y0 * stash->params.width];
 	for (y = 0; y < gh; y++) {
 		dst[y*stash->params.width] = 0;
 		dst[gw-1 + y*stash->params.width] = 0;
@@ -1179,7 +1549,7 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	}
 
 	// Debug code to color the glyph background
-/*	unsigned char* fdst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
+/*	unsigned char* fdst = &texData[glyph->x0 + glyph->y0 * stash->params.width];
 	for (y = 0; y < gh; y++) {
 		for (x = 0; x < gw; x++) {
 			int a = (int)fdst[x+y*stash->params.width] + 20;
@@ -1191,18 +1561,46 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	// Blur
 	if (iblur > 0) {
 		stash->nscratch = 0;
-		bdst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
+		bdst = &texData[glyph->x0 + glyph->y0 * stash->params.width];
 		fons__blur(stash, bdst, gw, gh, stash->params.width, iblur);
 	}
 
-	stash->dirtyRect[0] = fons__mini(stash->dirtyRect[0], glyph->x0);
-	stash->dirtyRect[1] = fons__mini(stash->dirtyRect[1], glyph->y0);
-	stash->dirtyRect[2] = fons__maxi(stash->dirtyRect[2], glyph->x1);
-	stash->dirtyRect[3] = fons__maxi(stash->dirtyRect[3], glyph->y1);
+	fons__addDirtyRect(&stash->pages[page], glyph->x0, glyph->y0, glyph->x1, glyph->y1);
 
 	return glyph;
 }
 
+// Draws a glyph that is still being rasterized with the same glyph at the
+// nearest size that is in the atlas, stretched over its quad, or as nothing.
+// Only the paths that draw swap it in, so that measuring the glyph doesn't
+// depend on whether it has been rasterized yet.
+static void fons__getStandInQuad(FONScontext* stash, FONSfont* font, FONSglyph* glyph, FONSquad* q)
+{
+	FONSglyph* standIn = NULL;
+	int i = font->lut[fons__hashint(glyph->codepoint) & (FONS_HASH_LUT_SIZE-1)];
+	while (i != -1) {
+		FONSglyph* other = &font->glyphs[i];
+		if (other->codepoint == glyph->codepoint && other->blur == glyph->blur &&
+			other->x0 >= 0 && !other->pending &&
+			(standIn == NULL || abs(other->size - glyph->size) < abs(standIn->size - glyph->size)))
+			standIn = other;
+		i = other->next;
+	}
+
+	if (standIn == NULL) {
+		q->x1 = q->x0;
+		q->y1 = q->y0;
+		return;
+	}
+
+	fons__touchGlyph(stash, standIn);
+	q->s0 = (standIn->x0+1) * stash->itw;
+	q->t0 = (standIn->y0+1) * stash->ith;
+	q->s1 = (standIn->x1-1) * stash->itw;
+	q->t1 = (standIn->y1-1) * stash->ith;
+	q->page = standIn->page;
+}
+
 static void fons__getQuad(FONScontext* stash, FONSfont* font,
 						   int prevGlyphIndex, FONSglyph* glyph,
 						   float scale, float spacing, float* x, float* y, FONSquad* q)
@@ -1224,9 +1622,11 @@ static void fons__getQuad(FONScontext* stash, FONSfont* font,
 	x1 = (float)(glyph->x1-1);
 	y1 = (float)(glyph->y1-1);
 
+	// Snap to the pixel below rather than towards zero, so that moving a
+	// string by whole pixels moves its quads by exactly as much.
 	if (stash->params.flags & FONS_ZERO_TOPLEFT) {
-		rx = (float)(int)(*x + xoff);
-		ry = (float)(int)(*y + yoff);
+		rx = floorf(*x + xoff);
+		ry = floorf(*y + yoff);
 
 		q->x0 = rx;
 		q->y0 = ry;
@@ -1237,9 +1637,10 @@ static void fons__getQuad(FONScontext* stash, FONSfont* font,
 		q->t0 = y0 * stash->ith;
 		q->s1 = x1 * stash->itw;
 		q->t1 = y1 * stash->ith;
+		q->page = glyph->page;
 	} else {
-		rx = (float)(int)(*x + xoff);
-		ry = (float)(int)(*y - yoff);
+		rx = floorf(*x + xoff);
+		ry = floorf(*y - yoff);
 
 		q->x0 = rx;
 		q->y0 = ry;
@@ -1250,6 +1651,7 @@ static void fons__getQuad(FONScontext* stash, FONSfont* font,
 		q->t0 = y0 * stash->ith;
 		q->s1 = x1 * stash->itw;
 		q->t1 = y1 * stash->ith;
+		q->page = glyph->page;
 	}
 
 	*x += (int)(glyph->xadv / 10.0f + 0.5f);
@@ -1257,15 +1659,12 @@ static void fons__getQuad(FONScontext* stash, FONSfont* font,
 
 static void fons__flush(FONScontext* stash)
 {
-	// Flush texture
-	if (stash->dirtyRect[0] < stash->dirtyRect[2] && stash->dirtyRect[1] < stash->dirtyRect[3]) {
+	// Flush texture. The render callbacks only know of the first page.
+	FONSpage* page = &stash->pages[0];
+	if (page->dirtyRect[0] < page->dirtyRect[2] && page->dirtyRect[1] < page->dirtyRect[3]) {
 		if (stash->params.renderUpdate != NULL)
-			stash->params.renderUpdate(stash->params.userPtr, stash->dirtyRect, stash->texData);
-		// Reset dirty rect
-		stash->dirtyRect[0] = stash->params.width;
-		stash->dirtyRect[1] = stash->params.height;
-		stash->dirtyRect[2] = 0;
-		stash->dirtyRect[3] = 0;
+			stash->params.renderUpdate(stash->params.userPtr, page->dirtyRect, page->texData);
+		fons__resetDirtyRect(stash, page);
 	}
 
 	// Flush triangles
@@ -1357,6 +1756,8 @@ float fonsDrawText(FONScontext* stash,
 		glyph = fons__getGlyph(stash, font, codepoint, isize, iblur, FONS_GLYPH_BITMAP_REQUIRED);
 		if (glyph != NULL) {
 			fons__getQuad(stash, font, prevGlyphIndex, glyph, scale, state->spacing, &x, &y, &q);
+			if (glyph->pending)
+				fons__getStandInQuad(stash, font, glyph, &q);
 
 			if (stash->nverts+6 > FONS_VERTEX_COUNT)
 				fons__flush(stash);
@@ -1417,6 +1818,8 @@ int fonsTextIterInit(FONScontext* stash, FONStextIter* iter,
 	iter->end = end;
 	iter->codepoint = 0;
 	iter->prevGlyphIndex = -1;
+	iter->cacheIndex = -1;
+	iter->pending = 0;
 	iter->bitmapOption = bitmapOption;
 
 	return 1;
@@ -1440,9 +1843,15 @@ int fonsTextIterNext(FONScontext* stash, FONStextIter* iter, FONSquad* quad)
 		iter->y = iter->nexty;
 		glyph = fons__getGlyph(stash, iter->font, iter->codepoint, iter->isize, iter->iblur, iter->bitmapOption);
 		// If the iterator was initialized with FONS_GLYPH_BITMAP_OPTIONAL, then the UV coordinates of the quad will be invalid.
-		if (glyph != NULL)
+		// With FONS_GLYPH_BITMAP_REQUIRED the quad is for drawing, so a pending glyph gets its stand-in.
+		if (glyph != NULL) {
 			fons__getQuad(stash, iter->font, iter->prevGlyphIndex, glyph, iter->scale, iter->spacing, &iter->nextx, &iter->nexty, quad);
+			if (glyph->pending && iter->bitmapOption == FONS_GLYPH_BITMAP_REQUIRED)
+				fons__getStandInQuad(stash, iter->font, glyph, quad);
+		}
 		iter->prevGlyphIndex = glyph != NULL ? glyph->index : -1;
+		iter->cacheIndex = glyph != NULL ? (int)(glyph - iter->font->glyphs) : -1;
+		iter->pending = glyph != NULL ? glyph->pending : 0;
 		break;
 	}
 	iter->next = str;
@@ -1480,8 +1889,8 @@ void fonsDrawDebug(FONScontext* stash, float x, float y)
 	fons__vertex(stash, x+w, y+h, 1, 1, 0xffffffff);
 
 	// Drawbug draw atlas
-	for (i = 0; i < stash->atlas->nnodes; i++) {
-		FONSatlasNode* n = &stash->atlas->nodes[i];
+	for (i = 0; i < stash->pages[0].atlas->nnodes; i++) {
+		FONSatlasNode* n = &stash->pages[0].atlas->nodes[i];
 
 		if (stash->nverts+6 > FONS_VERTEX_COUNT)
 			fons__flush(stash);
@@ -1619,32 +2028,418 @@ void fonsLineBounds(FONScontext* stash, float y, float* miny, float* maxy)
 	}
 }
 
-const unsigned char* fonsGetTextureData(FONScontext* stash, int* width, int* height)
+const unsigned char* fonsGetTextureData(FONScontext* stash, int page, int* width, int* height)
 {
 	if (width != NULL)
 		*width = stash->params.width;
 	if (height != NULL)
 		*height = stash->params.height;
-	return stash->texData;
+	if (page < 0 || page >= FONS_MAX_PAGES)
+		return NULL;
+	return stash->pages[page].texData;
 }
 
-int fonsValidateTexture(FONScontext* stash, int* dirty)
+int fonsValidateTexture(FONScontext* stash, int page, int* dirty)
 {
-	if (stash->dirtyRect[0] < stash->dirtyRect[2] && stash->dirtyRect[1] < stash->dirtyRect[3]) {
-		dirty[0] = stash->dirtyRect[0];
-		dirty[1] = stash->dirtyRect[1];
-		dirty[2] = stash->dirtyRect[2];
-		dirty[3] = stash->dirtyRect[3];
-		// Reset dirty rect
-		stash->dirtyRect[0] = stash->params.width;
-		stash->dirtyRect[1] = stash->params.height;
-		stash->dirtyRect[2] = 0;
-		stash->dirtyRect[3] = 0;
+	FONSpage* p;
+	if (page < 0 || page >= FONS_MAX_PAGES)
+		return 0;
+	p = &stash->pages[page];
+	if (p->atlas != NULL && p->dirtyRect[0] < p->dirtyRect[2] && p->dirtyRect[1] < p->dirtyRect[3]) {
+		dirty[0] = p->dirtyRect[0];
+		dirty[1] = p->dirtyRect[1];
+		dirty[2] = p->dirtyRect[2];
+		dirty[3] = p->dirtyRect[3];
+		fons__resetDirtyRect(stash, p);
 		return 1;
 	}
 	return 0;
 }
 
+int fonsGetGlyphMissCount(FONScontext* stash)
+{
+	return stash->nglyphMisses;
+}
+
+void fonsSetMaxPages(FONScontext* stash, int maxPages)
+{
+	if (stash == NULL) return;
+	stash->maxPages = fons__maxi(1, fons__mini(maxPages, FONS_MAX_PAGES));
+}
+
+void fonsBeginFrame(FONScontext* stash)
+{
+	if (stash == NULL) return;
+	stash->frame++;
+}
+
+void fonsTrimPages(FONScontext* stash)
+{
+	int i;
+	if (stash == NULL) return;
+	while (stash->npages > stash->maxPages) {
+		i = fons__findColdestPage(stash, 1);
+		if (i == -1) break;
+		fons__evictPage(stash, i);
+		fons__freePage(stash, i);
+	}
+}
+
+void fonsTouchGlyphs(FONScontext* stash, int font, const int* cacheIndices, int count)
+{
+	FONSfont* f;
+	int i;
+	if (stash == NULL) return;
+	if (font < 0 || font >= stash->nfonts) return;
+	f = stash->fonts[font];
+	for (i = 0; i < count; i++) {
+		FONSglyph* glyph;
+		if (cacheIndices[i] < 0 || cacheIndices[i] >= f->nglyphs) continue;
+		glyph = &f->glyphs[cacheIndices[i]];
+		if (glyph->x0 >= 0)
+			fons__touchGlyph(stash, glyph);
+	}
+}
+
+void fonsTouchPage(FONScontext* stash, int page)
+{
+	if (stash == NULL) return;
+	if (page < 0 || page >= FONS_MAX_PAGES || stash->pages[page].atlas == NULL) return;
+	stash->pages[page].lastUsed = stash->frame;
+}
+
+void fonsGetAtlasStats(FONScontext* stash, FONSatlasStats* stats)
+{
+	int i;
+	if (stash == NULL) return;
+	stats->npages = stash->npages;
+	stats->maxPages = stash->maxPages;
+	stats->pageWidth = stash->params.width;
+	stats->pageHeight = stash->params.height;
+	stats->nglyphs = 0;
+	for (i = 0; i < FONS_MAX_PAGES; i++)
+		stats->nglyphs += stash->pages[i].nglyphs;
+	stats->nevictedGlyphs = stash->nevictedGlyphs;
+	stats->nevictedPages = stash->nevictedPages;
+	stats->nglyphMisses = stash->nglyphMisses;
+	stats->npendingGlyphs = stash->npendingGlyphs;
+}
+
+void fonsSetGlyphJobCallback(FONScontext* stash, void (*callback)(void* uptr, FONSglyphJob* job), void* uptr)
+{
+	if (stash == NULL) return;
+	stash->glyphJobCallback = callback;
+	stash->glyphJobUptr = uptr;
+}
+
+void fonsRasterizeGlyphJob(FONSglyphJob* job)
+{
+	int pad = job->pad;
+	job->bitmap = (unsigned char*)calloc(job->width * job->height, 1);
+	if (job->bitmap == NULL) return;
+
+	// Leaves the one pixel border empty, like fons__getGlyph()
+	fons__tt_renderGlyphBitmap(&job->font, &job->bitmap[pad + pad * job->width], job->width-pad*2, job->height-pad*2,
+							   job->width, job->scale, job->scale, job->glyphIndex);
+	if (job->blur > 0)
+		fons__blur(NULL, job->bitmap, job->width, job->height, job->width, job->blur);
+}
+
+int fonsGlyphJobSize(FONSglyphJob* job)
+{
+	return job->width * job->height;
+}
+
+int fonsFinishGlyphJob(FONScontext* stash, FONSglyphJob* job)
+{
+	FONSpage* page = &stash->pages[job->page];
+	FONSglyph* glyph = NULL;
+	int y, finished = 0;
+
+	stash->npendingGlyphs--;
+
+	// The glyph is only still waiting for this job if its page is
+	if (page->atlas != NULL && page->generation == job->pageGeneration && job->cacheIndex < job->target->nglyphs) {
+		glyph = &job->target->glyphs[job->cacheIndex];
+		if (!glyph->pending || glyph->page != job->page || glyph->x0 != job->x || glyph->y0 != job->y)
+			glyph = NULL;
+	}
+
+	if (glyph != NULL && job->bitmap != NULL) {
+		for (y = 0; y < job->height; y++)
+			memcpy(&page->texData[job->x + (job->y + y) * stash->params.width], &job->bitmap[y * job->width], job->width);
+		fons__addDirtyRect(page, job->x, job->y, job->x + job->width, job->y + job->height);
+		glyph->pending = 0;
+		finished = 1;
+	} else if (glyph != NULL) {
+		// Out of memory, so rasterize it again next time
+		glyph->x1 = (short)(glyph->x1 - glyph->x0 - 1);
+		glyph->y1 = (short)(glyph->y1 - glyph->y0 - 1);
+		glyph->x0 = -1;
+		glyph->y0 = -1;
+		glyph->page = -1;
+		glyph->pending = 0;
+	}
+
+	free(job->bitmap);
+	free(job);
+	return finished;
+}
+
+static int fons__isSavedGlyph(FONSglyph* glyph)
+{
+	return glyph->x0 >= 0 && glyph->page >= 0 && !glyph->pending;
+}
+
+unsigned char* fonsSaveAtlas(FONScontext* stash, int* size)
+{
+	FONSsavedAtlas header;
+	FONSsavedFont savedFont;
+	FONSsavedGlyph savedGlyph;
+	int pageIndices[FONS_MAX_PAGES];
+	int i, j, nglyphs, texSize;
+	unsigned char* data;
+	unsigned char* dst;
+	if (stash == NULL) return NULL;
+
+	memset(&header, 0, sizeof(header));
+	header.magic = FONS_ATLAS_MAGIC;
+	header.version = FONS_ATLAS_VERSION;
+	header.width = stash->params.width;
+	header.height = stash->params.height;
+	texSize = header.width * header.height;
+
+	// Pages that have been freed leave gaps, which saving closes up
+	*size = sizeof(header);
+	for (i = 0; i < FONS_MAX_PAGES; i++) {
+		FONSpage* page = &stash->pages[i];
+		pageIndices[i] = -1;
+		if (page->atlas == NULL) continue;
+		pageIndices[i] = header.npages++;
+		*size += sizeof(int) + page->atlas->nnodes * sizeof(FONSatlasNode) + texSize;
+	}
+	for (i = 0; i < stash->nfonts; i++) {
+		FONSfont* font = stash->fonts[i];
+		nglyphs = 0;
+		for (j = 0; j < font->nglyphs; j++)
+			nglyphs += fons__isSavedGlyph(&font->glyphs[j]);
+		if (nglyphs == 0) continue;
+		header.nfonts++;
+		*size += sizeof(FONSsavedFont) + nglyphs * sizeof(FONSsavedGlyph);
+	}
+
+	data = (unsigned char*)malloc(*size);
+	if (data == NULL) return NULL;
+	dst = data;
+	memcpy(dst, &header, sizeof(header));
+	dst += sizeof(header);
+
+	for (i = 0; i < FONS_MAX_PAGES; i++) {
+		FONSpage* page = &stash->pages[i];
+		if (page->atlas == NULL) continue;
+		memcpy(dst, &page->atlas->nnodes, sizeof(int));
+		dst += sizeof(int);
+		memcpy(dst, page->atlas->nodes, page->atlas->nnodes * sizeof(FONSatlasNode));
+		dst += page->atlas->nnodes * sizeof(FONSatlasNode);
+		memcpy(dst, page->texData, texSize);
+		dst += texSize;
+	}
+
+	for (i = 0; i < stash->nfonts; i++) {
+		FONSfont* font = stash->fonts[i];
+		memset(&savedFont, 0, sizeof(savedFont));
+		for (j = 0; j < font->nglyphs; j++)
+			savedFont.nglyphs += fons__isSavedGlyph(&font->glyphs[j]);
+		if (savedFont.nglyphs == 0) continue;
+		memcpy(savedFont.hash, font->hash, sizeof(savedFont.hash));
+		memcpy(dst, &savedFont, sizeof(savedFont));
+		dst += sizeof(savedFont);
+
+		for (j = 0; j < font->nglyphs; j++) {
+			FONSglyph* glyph = &font->glyphs[j];
+			if (!fons__isSavedGlyph(glyph)) continue;
+			memset(&savedGlyph, 0, sizeof(savedGlyph));
+			savedGlyph.codepoint = glyph->codepoint;
+			savedGlyph.index = glyph->index;
+			savedGlyph.size = glyph->size;
+			savedGlyph.blur = glyph->blur;
+			savedGlyph.x0 = glyph->x0;
+			savedGlyph.y0 = glyph->y0;
+			savedGlyph.x1 = glyph->x1;
+			savedGlyph.y1 = glyph->y1;
+			savedGlyph.xadv = glyph->xadv;
+			savedGlyph.xoff = glyph->xoff;
+			savedGlyph.yoff = glyph->yoff;
+			savedGlyph.page = (short)pageIndices[glyph->page];
+			memcpy(dst, &savedGlyph, sizeof(savedGlyph));
+			dst += sizeof(savedGlyph);
+		}
+	}
+
+	return data;
+}
+
+// Restores a saved glyph into a font, unless the font has it already, or
+// would no longer draw it from its own data, e.g. because it came from a
+// fallback font.
+static int fons__loadGlyph(FONScontext* stash, FONSfont* font, const FONSsavedGlyph* saved, int npages)
+{
+	FONSglyph* glyph = NULL;
+	unsigned int h;
+	int i;
+
+	if (saved->page < 0 || saved->page >= npages || saved->size < 2 || saved->index == 0)
+		return 0;
+	if (saved->x0 < 0 || saved->y0 < 0 || saved->x1 <= saved->x0 || saved->y1 <= saved->y0 ||
+		saved->x1 > stash->params.width || saved->y1 > stash->params.height)
+		return 0;
+	if (fons__tt_getGlyphIndex(&font->font, saved->codepoint) != saved->index)
+		return 0;
+
+	h = fons__hashint(saved->codepoint) & (FONS_HASH_LUT_SIZE-1);
+	for (i = font->lut[h]; i != -1; i = font->glyphs[i].next) {
+		if (font->glyphs[i].codepoint == saved->codepoint && font->glyphs[i].size == saved->size && font->glyphs[i].blur == saved->blur) {
+			glyph = &font->glyphs[i];
+			break;
+		}
+	}
+	if (glyph != NULL && (glyph->x0 >= 0 || glyph->pending))
+		return 0;
+	if (glyph == NULL) {
+		glyph = fons__allocGlyph(font);
+		if (glyph == NULL) return 0;
+		glyph->codepoint = saved->codepoint;
+		glyph->size = saved->size;
+		glyph->blur = saved->blur;
+		glyph->next = font->lut[h];
+		font->lut[h] = font->nglyphs-1;
+	}
+	glyph->index = saved->index;
+	glyph->x0 = saved->x0;
+	glyph->y0 = saved->y0;
+	glyph->x1 = saved->x1;
+	glyph->y1 = saved->y1;
+	glyph->xadv = saved->xadv;
+	glyph->xoff = saved->xoff;
+	glyph->yoff = saved->yoff;
+	glyph->page = saved->page;
+	glyph->pending = 0;
+	glyph->lastUsed = 0;
+	stash->pages[saved->page].nglyphs++;
+	return 1;
+}
+
+// Returns the page data of saved atlas data, or NULL if the data is cut
+// short or its skylines are out of bounds, so that nothing is loaded from
+// a broken file.
+static const unsigned char* fons__checkSavedAtlas(const unsigned char* data, int size, FONSsavedAtlas* header)
+{
+	const unsigned char* src = data + sizeof(FONSsavedAtlas);
+	const unsigned char* end = data + size;
+	FONSatlasNode node;
+	FONSsavedFont savedFont;
+	int i, j, nnodes, x;
+
+	if (size < (int)sizeof(FONSsavedAtlas)) return NULL;
+	memcpy(header, data, sizeof(FONSsavedAtlas));
+	if (header->magic != FONS_ATLAS_MAGIC || header->version != FONS_ATLAS_VERSION ||
+		header->width < 1 || header->height < 1 || header->width > 32767 || header->height > 32767 ||
+		header->npages < 1 || header->npages > FONS_MAX_PAGES || header->nfonts < 0)
+		return NULL;
+
+	for (i = 0; i < header->npages; i++) {
+		if (end - src < (long)sizeof(int)) return NULL;
+		memcpy(&nnodes, src, sizeof(int));
+		src += sizeof(int);
+		if (nnodes < 1 || nnodes > header->width ||
+			end - src < (long)(nnodes * sizeof(FONSatlasNode)) + (long)header->width * header->height)
+			return NULL;
+		for (j = 0, x = 0; j < nnodes; j++) {
+			memcpy(&node, src + j * sizeof(FONSatlasNode), sizeof(node));
+			if (node.x != x || node.width < 1 || node.y < 0 || node.y > header->height)
+				return NULL;
+			x += node.width;
+		}
+		if (x != header->width) return NULL;
+		src += nnodes * sizeof(FONSatlasNode) + header->width * header->height;
+	}
+
+	for (i = 0; i < header->nfonts; i++) {
+		if (end - src < (long)sizeof(savedFont)) return NULL;
+		memcpy(&savedFont, src, sizeof(savedFont));
+		src += sizeof(savedFont);
+		if (savedFont.nglyphs < 0 || (end - src) / (long)sizeof(FONSsavedGlyph) < savedFont.nglyphs)
+			return NULL;
+		src += savedFont.nglyphs * sizeof(FONSsavedGlyph);
+	}
+
+	return data + sizeof(FONSsavedAtlas);
+}
+
+int fonsLoadAtlas(FONScontext* stash, const unsigned char* data, int size)
+{
+	FONSsavedAtlas header;
+	FONSsavedFont savedFont;
+	FONSsavedGlyph savedGlyph;
+	const unsigned char* src;
+	int i, j, k, nnodes, texSize, npages, nloaded = 0;
+	if (stash == NULL || data == NULL) return 0;
+
+	if (stash->npages != 1 || stash->pages[0].nglyphs != 0 || stash->npendingGlyphs != 0)
+		return 0;
+	src = fons__checkSavedAtlas(data, size, &header);
+	if (src == NULL || header.width != stash->params.width || header.height != stash->params.height)
+		return 0;
+	texSize = header.width * header.height;
+
+	// Pages beyond the maximum are skipped, along with their glyphs
+	npages = fons__mini(header.npages, fons__maxi(stash->maxPages, 1));
+	for (i = 0; i < header.npages; i++) {
+		FONSpage* page;
+		memcpy(&nnodes, src, sizeof(int));
+		src += sizeof(int);
+		if (i < npages && i > 0 && fons__addPage(stash) != i)
+			npages = i;
+		if (i >= npages) {
+			src += nnodes * sizeof(FONSatlasNode) + texSize;
+			continue;
+		}
+		page = &stash->pages[i];
+		if (nnodes > page->atlas->cnodes) {
+			FONSatlasNode* nodes = (FONSatlasNode*)realloc(page->atlas->nodes, nnodes * sizeof(FONSatlasNode));
+			if (nodes == NULL) return 0;
+			page->atlas->nodes = nodes;
+			page->atlas->cnodes = nnodes;
+		}
+		memcpy(page->atlas->nodes, src, nnodes * sizeof(FONSatlasNode));
+		page->atlas->nnodes = nnodes;
+		src += nnodes * sizeof(FONSatlasNode);
+		memcpy(page->texData, src, texSize);
+		src += texSize;
+		fons__addDirtyRect(page, 0, 0, header.width, header.height);
+	}
+
+	for (i = 0; i < header.nfonts; i++) {
+		FONSfont* font = NULL;
+		memcpy(&savedFont, src, sizeof(savedFont));
+		src += sizeof(savedFont);
+		for (j = 0; j < stash->nfonts; j++) {
+			if (stash->fonts[j]->hash[0] == savedFont.hash[0] && stash->fonts[j]->hash[1] == savedFont.hash[1]) {
+				font = stash->fonts[j];
+				break;
+			}
+		}
+		for (k = 0; k < savedFont.nglyphs; k++) {
+			memcpy(&savedGlyph, src, sizeof(savedGlyph));
+			src += sizeof(savedGlyph);
+			if (font != NULL)
+				nloaded += fons__loadGlyph(stash, font, &savedGlyph, npages);
+		}
+	}
+
+	return nloaded;
+}
+
 void fonsDeleteInternal(FONScontext* stash)
 {
 	int i;
@@ -1656,9 +2451,9 @@ void fonsDeleteInternal(FONScontext* stash)
 	for (i = 0; i < stash->nfonts; ++i)
 		fons__freeFont(stash->fonts[i]);
 
-	if (stash->atlas) fons__deleteAtlas(stash->atlas);
+	for (i = 0; i < FONS_MAX_PAGES; ++i)
+		fons__freePage(stash, i);
 	if (stash->fonts) free(stash->fonts);
-	if (stash->texData) free(stash->texData);
 	if (stash->scratch) free(stash->scratch);
 	free(stash);
 	fons__tt_done(stash);
@@ -1680,7 +2475,7 @@ void fonsGetAtlasSize(FONScontext* stash, int* width, int* height)
 
 int fonsExpandAtlas(FONScontext* stash, int width, int height)
 {
-	int i, maxy = 0;
+	int i, j, maxy = 0;
 	unsigned char* data = NULL;
 	if (stash == NULL) return 0;
 
@@ -1698,33 +2493,38 @@ int fonsExpandAtlas(FONScontext* stash, int width, int height)
 		if (stash->params.renderResize(stash->params.userPtr, width, height) == 0)
 			return 0;
 	}
-	// Copy old texture data over.
-	data = (unsigned char*)malloc(width * height);
-	if (data == NULL)
-		return 0;
-	for (i = 0; i < stash->params.height; i++) {
-		unsigned char* dst = &data[i*width];
-		unsigned char* src = &stash->texData[i*stash->params.width];
-		memcpy(dst, src, stash->params.width);
-		if (width > stash->params.width)
-			memset(dst+stash->params.width, 0, width - stash->params.width);
-	}
-	if (height > stash->params.height)
-		memset(&data[stash->params.height * width], 0, (height - stash->params.height) * width);
-
-	free(stash->texData);
-	stash->texData = data;
-
-	// Increase atlas size
-	fons__atlasExpand(stash->atlas, width, height);
-
-	// Add existing data as dirty.
-	for (i = 0; i < stash->atlas->nnodes; i++)
-		maxy = fons__maxi(maxy, stash->atlas->nodes[i].y);
-	stash->dirtyRect[0] = 0;
-	stash->dirtyRect[1] = 0;
-	stash->dirtyRect[2] = stash->params.width;
-	stash->dirtyRect[3] = maxy;
+	// Copy old texture data over, page by page.
+	for (j = 0; j < FONS_MAX_PAGES; j++) {
+		FONSpage* page = &stash->pages[j];
+		if (page->atlas == NULL) continue;
+		data = (unsigned char*)malloc(width * height);
+		if (data == NULL)
+			return 0;
+		for (i = 0; i < stash->params.height; i++) {
+			unsigned char* dst = &data[i*width];
+			unsigned char* src = &page->texData[i*stash->params.width];
+			memcpy(dst, src, stash->params.width);
+			if (width > stash->params.width)
+				memset(dst+stash->params.width, 0, width - stash->params.width);
+		}
+		if (height > stash->params.height)
+			memset(&data[stash->params.height * width], 0, (height - stash->params.height) * width);
+
+		free(page->texData);
+		page->texData = data;
+
+		// Increase atlas size
+		fons__atlasExpand(page->atlas, width, height);
+
+		// Add existing data as dirty.
+		maxy = 0;
+		for (i = 0; i < page->atlas->nnodes; i++)
+			maxy = fons__maxi(maxy, page->atlas->nodes[i].y);
+		page->dirtyRect[0] = 0;
+		page->dirtyRect[1] = 0;
+		page->dirtyRect[2] = stash->params.width;
+		page->dirtyRect[3] = maxy;
+	}
 
 	stash->params.width = width;
 	stash->params.height = height;
@@ -1737,6 +2537,7 @@ int fonsExpandAtlas(FONScontext* stash, int width, int height)
 int fonsResetAtlas(FONScontext* stash, int width, int height)
 {
 	int i, j;
+	FONSpage* page;
 	if (stash == NULL) return 0;
 
 	// Flush pending glyphs.
@@ -1748,19 +2549,14 @@ int fonsResetAtlas(FONScontext* stash, int width, int height)
 			return 0;
 	}
 
-	// Reset atlas
-	fons__atlasReset(stash->atlas, width, height);
+	// Keep only the first page.
+	for (i = 1; i < FONS_MAX_PAGES; i++)
+		fons__freePage(stash, i);
 
 	// Clear texture data.
-	stash->texData = (unsigned char*)realloc(stash->texData, width * height);
-	if (stash->texData == NULL) return 0;
-	memset(stash->texData, 0, width * height);
-
-	// Reset dirty rect
-	stash->dirtyRect[0] = width;
-	stash->dirtyRect[1] = height;
-	stash->dirtyRect[2] = 0;
-	stash->dirtyRect[3] = 0;
+	page = &stash->pages[0];
+	page->texData = (unsigned char*)realloc(page->texData, width * height);
+	if (page->texData == NULL) return 0;
 
 	// Reset cached glyphs
 	for (i = 0; i < stash->nfonts; i++) {
@@ -1775,8 +2571,8 @@ int fonsResetAtlas(FONScontext* stash, int width, int height)
 	stash->itw = 1.0f/stash->params.width;
 	stash->ith = 1.0f/stash->params.height;
 
-	// Add white rect at 0,0 for debug drawing.
-	fons__addWhiteRect(stash, 2,2);
+	// Reset atlas and dirty rect, and add white rect at 0,0 for debug drawing.
+	fons__clearPage(stash, 0);
 
 	return 1;
 }
@@ -34,9 +34,8 @@
 #pragma warning(disable: 4706)  // assignment within conditional expression
 #endif
 
-#define NVG_INIT_FONTIMAGE_SIZE  512
-#define NVG_MAX_FONTIMAGE_SIZE   2048
-#define NVG_MAX_FONTIMAGES       4
+#define NVG_FONT_PAGE_SIZE             512
+#define NVG_DEFAULT_FONT_ATLAS_BUDGET  (4*1024*1024)
 
 #define NVG_INIT_COMMANDS_SIZE 256
 #define NVG_INIT_POINTS_SIZE 128
@@ -44,6 +43,10 @@
 #define NVG_INIT_VERTS_SIZE 256
 #define NVG_MAX_STATES 32
 
+#define NVG_TEXT_RUN_SETS        256
+#define NVG_TEXT_RUN_WAYS        4
+#define NVG_TEXT_RUN_MAX_LENGTH  128
+
 #define NVG_KAPPA90 0.5522847493f	// Length proportional to radius of a cubic bezier handle for 90deg arcs.
 
 #define NVG_COUNTOF(arr) (sizeof(arr) / sizeof(0[arr]))
@@ -109,6 +112,34 @@ struct NVGpathCache {
 };
 typedef struct NVGpathCache NVGpathCache;
 
+// The quads of a string drawn by nvgText(), in font pixels relative to the
+// whole pixel the string started at, and where their glyphs are in the
+// font cache. Runs are looked up by a hash of the string and everything
+// its quads depend on, and are only valid for the font atlas and the fonts
+// they were laid out with.
+struct NVGtextRun {
+	unsigned int hash;
+	int valid;
+	unsigned long long lastUsed;
+	int fontId;
+	float fontSize;
+	float letterSpacing;
+	float fontBlur;
+	int textAlign;
+	float scale;
+	float fracx, fracy;
+	int fontAtlasGeneration;
+	int fontGeneration;
+	int length;
+	char string[NVG_TEXT_RUN_MAX_LENGTH];
+	float advance;
+	FONSquad* quads;
+	int* glyphs;
+	int nquads;
+	int cquads;
+};
+typedef struct NVGtextRun NVGtextRun;
+
 struct NVGcontext {
 	NVGparams params;
 	float* commands;
@@ -123,8 +154,16 @@ struct NVGcontext {
 	float fringeWidth;
 	float devicePxRatio;
 	struct FONScontext* fs;
-	int fontImages[NVG_MAX_FONTIMAGES];
-	int fontImageIdx;
+	int fontImages[FONS_MAX_PAGES];
+	int fontEvictedPages;
+	int fontAtlasGeneration;
+	int fontGeneration;
+	int fontGlyphMisses;
+	NVGtextRun* textRuns;
+	unsigned long long textRunClock;
+	NVGrenderStats renderStats;
+	float cullBounds[4];
+	int cull;
 	int drawCallCount;
 	int fillTriCount;
 	int strokeTriCount;
@@ -292,7 +331,9 @@ NVGcontext* nvgCreateInternal(NVGparams* params)
 	memset(ctx, 0, sizeof(NVGcontext));
 
 	ctx->params = *params;
-	for (i = 0; i < NVG_MAX_FONTIMAGES; i++)
+	if (ctx->params.renderStats == NULL)
+		ctx->params.renderStats = &ctx->renderStats;
+	for (i = 0; i < FONS_MAX_PAGES; i++)
 		ctx->fontImages[i] = 0;
 
 	ctx->commands = (float*)malloc(sizeof(float)*NVG_INIT_COMMANDS_SIZE);
@@ -303,6 +344,9 @@ NVGcontext* nvgCreateInternal(NVGparams* params)
 	ctx->cache = nvg__allocPathCache();
 	if (ctx->cache == NULL) goto error;
 
+	ctx->textRuns = (NVGtextRun*)calloc(NVG_TEXT_RUN_SETS * NVG_TEXT_RUN_WAYS, sizeof(NVGtextRun));
+	if (ctx->textRuns == NULL) goto error;
+
 	nvgSave(ctx);
 	nvgReset(ctx);
 
@@ -312,8 +356,8 @@ NVGcontext* nvgCreateInternal(NVGparams* params)
 
 	// Init font rendering
 	memset(&fontParams, 0, sizeof(fontParams));
-	fontParams.width = NVG_INIT_FONTIMAGE_SIZE;
-	fontParams.height = NVG_INIT_FONTIMAGE_SIZE;
+	fontParams.width = NVG_FONT_PAGE_SIZE;
+	fontParams.height = NVG_FONT_PAGE_SIZE;
 	fontParams.flags = FONS_ZERO_TOPLEFT;
 	fontParams.renderCreate = NULL;
 	fontParams.renderUpdate = NULL;
@@ -322,11 +366,11 @@ NVGcontext* nvgCreateInternal(NVGparams* params)
 	fontParams.userPtr = NULL;
 	ctx->fs = fonsCreateInternal(&fontParams);
 	if (ctx->fs == NULL) goto error;
+	nvgFontAtlasBudget(ctx, NVG_DEFAULT_FONT_ATLAS_BUDGET);
 
-	// Create font texture
+	// Create font texture for the first page, the others are created as needed
 	ctx->fontImages[0] = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, fontParams.width, fontParams.height, 0, NULL);
 	if (ctx->fontImages[0] == 0) goto error;
-	ctx->fontImageIdx = 0;
 
 	return ctx;
 
@@ -340,17 +384,123 @@ NVGparams* nvgInternalParams(NVGcontext* ctx)
     return &ctx->params;
 }
 
+NVGrenderStats* nvgInternalRenderStats(NVGcontext* ctx)
+{
+	int glyphMisses = fonsGetGlyphMissCount(ctx->fs);
+	ctx->params.renderStats->glyphMisses += glyphMisses - ctx->fontGlyphMisses;
+	ctx->fontGlyphMisses = glyphMisses;
+	return ctx->params.renderStats;
+}
+
+int nvgInternalFontAtlasGeneration(NVGcontext* ctx)
+{
+	return ctx->fontAtlasGeneration;
+}
+
+void nvgInternalGlyphJobCallback(NVGcontext* ctx, void (*callback)(void* uptr, FONSglyphJob* job), void* uptr)
+{
+	fonsSetGlyphJobCallback(ctx->fs, callback, uptr);
+}
+
+void nvgInternalRasterizeGlyphJob(FONSglyphJob* job)
+{
+	fonsRasterizeGlyphJob(job);
+}
+
+int nvgInternalGlyphJobSize(FONSglyphJob* job)
+{
+	return fonsGlyphJobSize(job);
+}
+
+int nvgInternalFinishGlyphJob(NVGcontext* ctx, FONSglyphJob* job)
+{
+	// Text drawn since the job was queued has a stand-in for the glyph
+	if (!fonsFinishGlyphJob(ctx->fs, job))
+		return 0;
+	++ctx->fontAtlasGeneration;
+	return 1;
+}
+
+unsigned char* nvgInternalSaveFontAtlas(NVGcontext* ctx, int* size)
+{
+	return fonsSaveAtlas(ctx->fs, size);
+}
+
+int nvgInternalLoadFontAtlas(NVGcontext* ctx, const unsigned char* data, int size)
+{
+	int nglyphs = fonsLoadAtlas(ctx->fs, data, size);
+	if (nglyphs > 0)
+		++ctx->fontAtlasGeneration;
+	return nglyphs;
+}
+
+void nvgInternalPrewarmGlyphs(NVGcontext* ctx, int font, float size, float pixelRatio, const char* string, const char* end)
+{
+	FONStextIter iter;
+	FONSquad q;
+
+	if (font == FONS_INVALID) return;
+	if (end == NULL)
+		end = string + strlen(string);
+
+	// Sized the way nvgText() sizes text without a transform
+	fonsSetFont(ctx->fs, font);
+	fonsSetSize(ctx->fs, size*pixelRatio);
+	fonsSetSpacing(ctx->fs, 0);
+	fonsSetBlur(ctx->fs, 0);
+	fonsSetAlign(ctx->fs, NVG_ALIGN_LEFT | NVG_ALIGN_BASELINE);
+	fonsTextIterInit(ctx->fs, &iter, 0, 0, string, end, FONS_GLYPH_BITMAP_REQUIRED);
+	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
+		if (iter.prevGlyphIndex == -1) // the atlas is full
+			break;
+	}
+}
+
+void nvgInternalTouchFontImage(NVGcontext* ctx, int image)
+{
+	int i;
+	if (image == 0) return;
+	for (i = 0; i < FONS_MAX_PAGES; i++) {
+		if (ctx->fontImages[i] == image) {
+			fonsTouchPage(ctx->fs, i);
+			return;
+		}
+	}
+}
+
+static float nvg__getFontScale(NVGstate* state);
+
+void nvgInternalTextState(NVGcontext* ctx, NVGtextState* textState)
+{
+	NVGstate* state = nvg__getState(ctx);
+	textState->fontId = state->fontId;
+	textState->fontSize = state->fontSize;
+	textState->letterSpacing = state->letterSpacing;
+	textState->lineHeight = state->lineHeight;
+	textState->fontBlur = state->fontBlur;
+	textState->textAlign = state->textAlign;
+	textState->scale = nvg__getFontScale(state) * ctx->devicePxRatio;
+	textState->fontGeneration = ctx->fontGeneration;
+}
+
 void nvgDeleteInternal(NVGcontext* ctx)
 {
 	int i;
 	if (ctx == NULL) return;
 	if (ctx->commands != NULL) free(ctx->commands);
 	if (ctx->cache != NULL) nvg__deletePathCache(ctx->cache);
+	if (ctx->textRuns != NULL) {
+		for (i = 0; i < NVG_TEXT_RUN_SETS * NVG_TEXT_RUN_WAYS; i++) {
+			free(ctx->textRuns[i].quads);
+			free(ctx->textRuns[i].glyphs);
+		}
+		free(ctx->textRuns);
+	}
 
 	if (ctx->fs)
 		fonsDeleteInternal(ctx->fs);
 
-	for (i = 0; i < NVG_MAX_FONTIMAGES; i++) {
+	for (i = 0; i < FONS_MAX_PAGES; i++) {
 		if (ctx->fontImages[i] != 0) {
 			nvgDeleteImage(ctx, ctx->fontImages[i]);
 			ctx->fontImages[i] = 0;
@@ -374,6 +524,7 @@ void nvgBeginFrame(NVGcontext* ctx, float windowWidth, float windowHeight, float
 	nvgReset(ctx);
 
 	nvg__setDevicePixelRatio(ctx, devicePixelRatio);
+	fonsBeginFrame(ctx->fs);
 
 	ctx->params.renderViewport(ctx->params.userPtr, windowWidth, windowHeight, devicePixelRatio);
 
@@ -388,33 +539,24 @@ void nvgCancelFrame(NVGcontext* ctx)
 	ctx->params.renderCancel(ctx->params.userPtr);
 }
 
+static void nvg__flushTextTexture(NVGcontext* ctx);
+static void nvg__syncFontAtlas(NVGcontext* ctx);
+
 void nvgEndFrame(NVGcontext* ctx)
 {
+	int i;
+	// Upload glyphs that arrived without being drawn
+	nvg__flushTextTexture(ctx);
 	ctx->params.renderFlush(ctx->params.userPtr);
-	if (ctx->fontImageIdx != 0) {
-		int fontImage = ctx->fontImages[ctx->fontImageIdx];
-		int i, j, iw, ih;
-		// delete images that smaller than current one
-		if (fontImage == 0)
-			return;
-		nvgImageSize(ctx, fontImage, &iw, &ih);
-		for (i = j = 0; i < ctx->fontImageIdx; i++) {
-			if (ctx->fontImages[i] != 0) {
-				int nw, nh;
-				nvgImageSize(ctx, ctx->fontImages[i], &nw, &nh);
-				if (nw < iw || nh < ih)
-					nvgDeleteImage(ctx, ctx->fontImages[i]);
-				else
-					ctx->fontImages[j++] = ctx->fontImages[i];
-			}
-		}
-		// make current font image to first
-		ctx->fontImages[j++] = ctx->fontImages[0];
-		ctx->fontImages[0] = fontImage;
-		ctx->fontImageIdx = 0;
-		// clear all images after j
-		for (i = j; i < NVG_MAX_FONTIMAGES; i++)
+
+	// Give back the pages that went over the budget
+	fonsTrimPages(ctx->fs);
+	nvg__syncFontAtlas(ctx);
+	for (i = 1; i < FONS_MAX_PAGES; i++) {
+		if (ctx->fontImages[i] != 0 && fonsGetTextureData(ctx->fs, i, NULL, NULL) == NULL) {
+			nvgDeleteImage(ctx, ctx->fontImages[i]);
 			ctx->fontImages[i] = 0;
+		}
 	}
 }
 
@@ -1021,6 +1163,20 @@ void nvgResetScissor(NVGcontext* ctx)
 	state->scissor.extent[1] = -1.0f;
 }
 
+void nvgCullRect(NVGcontext* ctx, float x, float y, float w, float h)
+{
+	ctx->cullBounds[0] = x;
+	ctx->cullBounds[1] = y;
+	ctx->cullBounds[2] = x + w;
+	ctx->cullBounds[3] = y + h;
+	ctx->cull = 1;
+}
+
+void nvgResetCullRect(NVGcontext* ctx)
+{
+	ctx->cull = 0;
+}
+
 // Global composite operation.
 void nvgGlobalCompositeOperation(NVGcontext* ctx, int op)
 {
@@ -2216,6 +2372,28 @@ void nvgDebugDumpPathCache(NVGcontext* ctx)
 	}
 }
 
+// Returns 1 if the bounds, grown by margin, lie completely outside of the
+// current scissor or the cull rectangle, in which case there is nothing to draw.
+static int nvg__isCulled(NVGcontext* ctx, NVGstate* state, const float* bounds, float margin)
+{
+	NVGscissor* scissor = &state->scissor;
+	float ex, ey;
+	if (ctx->cull &&
+		(bounds[2] + margin < ctx->cullBounds[0] ||
+		 bounds[0] - margin > ctx->cullBounds[2] ||
+		 bounds[3] + margin < ctx->cullBounds[1] ||
+		 bounds[1] - margin > ctx->cullBounds[3]))
+		return 1;
+	if (scissor->extent[0] < 0.0f || scissor->extent[1] < 0.0f)
+		return 0;
+	ex = nvg__absf(scissor->xform[0])*scissor->extent[0] + nvg__absf(scissor->xform[2])*scissor->extent[1];
+	ey = nvg__absf(scissor->xform[1])*scissor->extent[0] + nvg__absf(scissor->xform[3])*scissor->extent[1];
+	return bounds[2] + margin < scissor->xform[4] - ex ||
+		   bounds[0] - margin > scissor->xform[4] + ex ||
+		   bounds[3] + margin < scissor->xform[5] - ey ||
+		   bounds[1] - margin > scissor->xform[5] + ey;
+}
+
 void nvgFill(NVGcontext* ctx)
 {
 	NVGstate* state = nvg__getState(ctx);
@@ -2224,6 +2402,8 @@ void nvgFill(NVGcontext* ctx)
 	int i;
 
 	nvg__flattenPaths(ctx);
+	if (nvg__isCulled(ctx, state, ctx->cache->bounds, ctx->fringeWidth))
+		return;
 	if (ctx->params.edgeAntiAlias && state->shapeAntiAlias)
 		nvg__expandFill(ctx, ctx->fringeWidth, NVG_MITER, 2.4f);
 	else
@@ -2269,6 +2449,8 @@ void nvgStroke(NVGcontext* ctx)
 	strokePaint.outerColor.a *= state->alpha;
 
 	nvg__flattenPaths(ctx);
+	if (nvg__isCulled(ctx, state, ctx->cache->bounds, strokeWidth*0.5f*nvg__maxf(state->miterLimit, 1.0f) + ctx->fringeWidth))
+		return;
 
 	if (ctx->params.edgeAntiAlias && state->shapeAntiAlias)
 		nvg__expandStroke(ctx, strokeWidth*0.5f, ctx->fringeWidth, state->lineCap, state->lineJoin, state->miterLimit);
@@ -2289,21 +2471,25 @@ void nvgStroke(NVGcontext* ctx)
 // Add fonts
 int nvgCreateFont(NVGcontext* ctx, const char* name, const char* filename)
 {
+	ctx->fontGeneration++;
 	return fonsAddFont(ctx->fs, name, filename, 0);
 }
 
 int nvgCreateFontAtIndex(NVGcontext* ctx, const char* name, const char* filename, const int fontIndex)
 {
+	ctx->fontGeneration++;
 	return fonsAddFont(ctx->fs, name, filename, fontIndex);
 }
 
 int nvgCreateFontMem(NVGcontext* ctx, const char* name, unsigned char* data, int ndata, int freeData)
 {
+	ctx->fontGeneration++;
 	return fonsAddFontMem(ctx->fs, name, data, ndata, freeData, 0);
 }
 
 int nvgCreateFontMemAtIndex(NVGcontext* ctx, const char* name, unsigned char* data, int ndata, int freeData, const int fontIndex)
 {
+	ctx->fontGeneration++;
 	return fonsAddFontMem(ctx->fs, name, data, ndata, freeData, fontIndex);
 }
 
@@ -2317,6 +2503,7 @@ int nvgFindFont(NVGcontext* ctx, const char* name)
 int nvgAddFallbackFontId(NVGcontext* ctx, int baseFont, int fallbackFont)
 {
 	if(baseFont == -1 || fallbackFont == -1) return 0;
+	ctx->fontGeneration++;
 	return fonsAddFallbackFont(ctx->fs, baseFont, fallbackFont);
 }
 
@@ -2327,6 +2514,7 @@ int nvgAddFallbackFont(NVGcontext* ctx, const char* baseFont, const char* fallba
 
 void nvgResetFallbackFontsId(NVGcontext* ctx, int baseFont)
 {
+	ctx->fontGeneration++;
 	fonsResetFallbackFont(ctx->fs, baseFont);
 }
 
@@ -2335,6 +2523,27 @@ void nvgResetFallbackFonts(NVGcontext* ctx, const char* baseFont)
 	nvgResetFallbackFontsId(ctx, nvgFindFont(ctx, baseFont));
 }
 
+void nvgFontAtlasBudget(NVGcontext* ctx, int bytes)
+{
+	int pageWidth = NVG_FONT_PAGE_SIZE, pageHeight = NVG_FONT_PAGE_SIZE;
+	fonsGetAtlasSize(ctx->fs, &pageWidth, &pageHeight);
+	fonsSetMaxPages(ctx->fs, bytes / (pageWidth * pageHeight));
+}
+
+void nvgFontAtlasStats(NVGcontext* ctx, NVGfontAtlasStats* stats)
+{
+	FONSatlasStats fontStats;
+	fonsGetAtlasStats(ctx->fs, &fontStats);
+	stats->pages = fontStats.npages;
+	stats->maxPages = fontStats.maxPages;
+	stats->bytes = fontStats.npages * fontStats.pageWidth * fontStats.pageHeight;
+	stats->glyphs = fontStats.nglyphs;
+	stats->evictedGlyphs = fontStats.nevictedGlyphs;
+	stats->evictedPages = fontStats.nevictedPages;
+	stats->glyphMisses = fontStats.nglyphMisses;
+	stats->pendingGlyphs = fontStats.npendingGlyphs;
+}
+
 // State setting
 void nvgFontSize(NVGcontext* ctx, float size)
 {
@@ -2391,53 +2600,47 @@ static float nvg__getFontScale(NVGstate* state)
 static void nvg__flushTextTexture(NVGcontext* ctx)
 {
 	int dirty[4];
-
-	if (fonsValidateTexture(ctx->fs, dirty)) {
-		int fontImage = ctx->fontImages[ctx->fontImageIdx];
+	int i, iw, ih;
+	const unsigned char* data;
+
+	for (i = 0; i < FONS_MAX_PAGES; i++) {
+		if (!fonsValidateTexture(ctx->fs, i, dirty))
+			continue;
+		data = fonsGetTextureData(ctx->fs, i, &iw, &ih);
+		if (ctx->fontImages[i] == 0)
+			ctx->fontImages[i] = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, iw, ih, 0, NULL);
 		// Update texture
-		if (fontImage != 0) {
-			int iw, ih;
-			const unsigned char* data = fonsGetTextureData(ctx->fs, &iw, &ih);
+		if (ctx->fontImages[i] != 0) {
 			int x = dirty[0];
 			int y = dirty[1];
 			int w = dirty[2] - dirty[0];
 			int h = dirty[3] - dirty[1];
-			ctx->params.renderUpdateTexture(ctx->params.userPtr, fontImage, x,y, w,h, data);
+			ctx->params.renderUpdateTexture(ctx->params.userPtr, ctx->fontImages[i], x,y, w,h, data);
 		}
 	}
 }
 
-static int nvg__allocTextAtlas(NVGcontext* ctx)
+// Glyphs evicted from the atlas leave their pages to other glyphs, so text
+// vertices kept from before are no longer valid.
+static void nvg__syncFontAtlas(NVGcontext* ctx)
 {
-	int iw, ih;
-	nvg__flushTextTexture(ctx);
-	if (ctx->fontImageIdx >= NVG_MAX_FONTIMAGES-1)
-		return 0;
-	// if next fontImage already have a texture
-	if (ctx->fontImages[ctx->fontImageIdx+1] != 0)
-		nvgImageSize(ctx, ctx->fontImages[ctx->fontImageIdx+1], &iw, &ih);
-	else { // calculate the new font image size and create it.
-		nvgImageSize(ctx, ctx->fontImages[ctx->fontImageIdx], &iw, &ih);
-		if (iw > ih)
-			ih *= 2;
-		else
-			iw *= 2;
-		if (iw > NVG_MAX_FONTIMAGE_SIZE || ih > NVG_MAX_FONTIMAGE_SIZE)
-			iw = ih = NVG_MAX_FONTIMAGE_SIZE;
-		ctx->fontImages[ctx->fontImageIdx+1] = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, iw, ih, 0, NULL);
+	FONSatlasStats stats;
+	fonsGetAtlasStats(ctx->fs, &stats);
+	if (stats.nevictedPages != ctx->fontEvictedPages) {
+		ctx->fontEvictedPages = stats.nevictedPages;
+		++ctx->fontAtlasGeneration;
 	}
-	++ctx->fontImageIdx;
-	fonsResetAtlas(ctx->fs, iw, ih);
-	return 1;
 }
 
-static void nvg__renderText(NVGcontext* ctx, NVGvertex* verts, int nverts)
+static void nvg__renderText(NVGcontext* ctx, NVGvertex* verts, int nverts, int page)
 {
 	NVGstate* state = nvg__getState(ctx);
 	NVGpaint paint = state->fill;
 
+	if (nverts == 0) return;
+
 	// Render triangles.
-	paint.image = ctx->fontImages[ctx->fontImageIdx];
+	paint.image = ctx->fontImages[page];
 
 	// Apply global alpha
 	paint.innerColor.a *= state->alpha;
@@ -2449,22 +2652,185 @@ static void nvg__renderText(NVGcontext* ctx, NVGvertex* verts, int nverts)
 	ctx->textTriCount += nverts/3;
 }
 
+static unsigned int nvg__hashTextRun(NVGstate* state, float scale, float fracx, float fracy, const char* string, int length)
+{
+	float params[6];
+	const unsigned char* bytes;
+	unsigned int hash = 2166136261u;
+	int i;
+
+	params[0] = state->fontSize;
+	params[1] = state->letterSpacing;
+	params[2] = state->fontBlur;
+	params[3] = scale;
+	params[4] = fracx;
+	params[5] = fracy;
+	bytes = (const unsigned char*)params;
+	for (i = 0; i < (int)sizeof(params); i++)
+		hash = (hash ^ bytes[i]) * 16777619u;
+	hash = (hash ^ (unsigned int)state->fontId) * 16777619u;
+	hash = (hash ^ (unsigned int)state->textAlign) * 16777619u;
+	bytes = (const unsigned char*)string;
+	for (i = 0; i < length; i++)
+		hash = (hash ^ bytes[i]) * 16777619u;
+	return hash;
+}
+
+static int nvg__textRunMatches(NVGcontext* ctx, NVGtextRun* run, unsigned int hash, NVGstate* state,
+							   float scale, float fracx, float fracy, const char* string, int length)
+{
+	return run->valid &&
+		run->hash == hash &&
+		run->fontAtlasGeneration == ctx->fontAtlasGeneration &&
+		run->fontGeneration == ctx->fontGeneration &&
+		run->fontId == state->fontId &&
+		run->fontSize == state->fontSize &&
+		run->letterSpacing == state->letterSpacing &&
+		run->fontBlur == state->fontBlur &&
+		run->textAlign == state->textAlign &&
+		run->scale == scale &&
+		run->fracx == fracx &&
+		run->fracy == fracy &&
+		run->length == length &&
+		memcmp(run->string, string, length) == 0;
+}
+
+// Returns the cached run of the string, or the run to record it into on a
+// miss, which replaces the least recently used run of its set. Returns NULL
+// if the string is too long to cache.
+static NVGtextRun* nvg__findTextRun(NVGcontext* ctx, NVGstate* state, float scale, float fracx, float fracy,
+									const char* string, int length, int* found)
+{
+	NVGtextRun* set;
+	NVGtextRun* run = NULL;
+	unsigned int hash;
+	int i;
+
+	*found = 0;
+	if (length > NVG_TEXT_RUN_MAX_LENGTH) return NULL;
+
+	hash = nvg__hashTextRun(state, scale, fracx, fracy, string, length);
+	set = &ctx->textRuns[(hash % NVG_TEXT_RUN_SETS) * NVG_TEXT_RUN_WAYS];
+	for (i = 0; i < NVG_TEXT_RUN_WAYS; i++) {
+		if (nvg__textRunMatches(ctx, &set[i], hash, state, scale, fracx, fracy, string, length)) {
+			set[i].lastUsed = ++ctx->textRunClock;
+			*found = 1;
+			return &set[i];
+		}
+		// Runs that aren't valid are replaced first
+		if (run == NULL || (run->valid && (!set[i].valid || set[i].lastUsed < run->lastUsed)))
+			run = &set[i];
+	}
+
+	run->hash = hash;
+	run->valid = 0; // not until recorded in full
+	run->fontId = state->fontId;
+	run->fontSize = state->fontSize;
+	run->letterSpacing = state->letterSpacing;
+	run->fontBlur = state->fontBlur;
+	run->textAlign = state->textAlign;
+	run->scale = scale;
+	run->fracx = fracx;
+	run->fracy = fracy;
+	run->fontAtlasGeneration = ctx->fontAtlasGeneration;
+	run->fontGeneration = ctx->fontGeneration;
+	run->length = length;
+	memcpy(run->string, string, length);
+	run->nquads = 0;
+	return run;
+}
+
+static int nvg__textRunAddQuad(NVGtextRun* run, FONSquad* q, int glyph)
+{
+	if (run->nquads+1 > run->cquads) {
+		int cquads = nvg__maxi(run->nquads+1, 16) + run->cquads/2;
+		FONSquad* quads = (FONSquad*)realloc(run->quads, sizeof(FONSquad)*cquads);
+		int* glyphs;
+		if (quads == NULL) return 0;
+		run->quads = quads;
+		glyphs = (int*)realloc(run->glyphs, sizeof(int)*cquads);
+		if (glyphs == NULL) return 0;
+		run->glyphs = glyphs;
+		run->cquads = cquads;
+	}
+	run->quads[run->nquads] = *q;
+	run->glyphs[run->nquads] = glyph;
+	run->nquads++;
+	return 1;
+}
+
+static int nvg__textQuadVerts(NVGvertex* verts, float* xform, FONSquad* q, float originx, float originy, float invscale)
+{
+	float c[4*2];
+	float x0 = (originx + q->x0) * invscale;
+	float y0 = (originy + q->y0) * invscale;
+	float x1 = (originx + q->x1) * invscale;
+	float y1 = (originy + q->y1) * invscale;
+
+	// Transform corners.
+	nvgTransformPoint(&c[0],&c[1], xform, x0, y0);
+	nvgTransformPoint(&c[2],&c[3], xform, x1, y0);
+	nvgTransformPoint(&c[4],&c[5], xform, x1, y1);
+	nvgTransformPoint(&c[6],&c[7], xform, x0, y1);
+	// Create triangles
+	nvg__vset(&verts[0], c[0], c[1], q->s0, q->t0);
+	nvg__vset(&verts[1], c[4], c[5], q->s1, q->t1);
+	nvg__vset(&verts[2], c[2], c[3], q->s1, q->t0);
+	nvg__vset(&verts[3], c[0], c[1], q->s0, q->t0);
+	nvg__vset(&verts[4], c[6], c[7], q->s0, q->t1);
+	nvg__vset(&verts[5], c[4], c[5], q->s1, q->t1);
+	return 6;
+}
+
 float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char* end)
 {
 	NVGstate* state = nvg__getState(ctx);
-	FONStextIter iter, prevIter;
+	FONStextIter iter;
 	FONSquad q;
 	NVGvertex* verts;
+	NVGtextRun* run;
 	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
 	float invscale = 1.0f / scale;
+	float originx, originy, fracx, fracy;
 	int cverts = 0;
 	int nverts = 0;
+	int page = 0;
+	int found, i;
 
 	if (end == NULL)
 		end = string + strlen(string);
 
 	if (state->fontId == FONS_INVALID) return x;
 
+	// Glyphs are snapped to whole pixels, so the quads of a string only
+	// depend on where it starts within a pixel. They are laid out from
+	// that fraction, and moved to the whole pixel as they're transformed.
+	originx = floorf(x*scale);
+	originy = floorf(y*scale);
+	fracx = x*scale - originx;
+	fracy = y*scale - originy;
+
+	// Quads on different atlas pages are drawn as separate calls
+	run = nvg__findTextRun(ctx, state, scale, fracx, fracy, string, (int)(end - string), &found);
+	if (found) {
+		cverts = nvg__maxi(1, run->nquads) * 6;
+		verts = nvg__allocTempVerts(ctx, cverts);
+		if (verts == NULL) return x;
+		fonsTouchGlyphs(ctx->fs, state->fontId, run->glyphs, run->nquads);
+		nvg__flushTextTexture(ctx);
+		for (i = 0; i < run->nquads; i++) {
+			if (run->quads[i].page != page) {
+				nvg__renderText(ctx, verts, nverts, page);
+				verts += nverts;
+				nverts = 0;
+				page = run->quads[i].page;
+			}
+			nverts += nvg__textQuadVerts(&verts[nverts], state->xform, &run->quads[i], originx, originy, invscale);
+		}
+		nvg__renderText(ctx, verts, nverts, page);
+		return (originx + run->advance) * invscale;
+	}
+
 	fonsSetSize(ctx->fs, state->fontSize*scale);
 	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
 	fonsSetBlur(ctx->fs, state->fontBlur*scale);
@@ -2475,45 +2841,43 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
 	verts = nvg__allocTempVerts(ctx, cverts);
 	if (verts == NULL) return x;
 
-	fonsTextIterInit(ctx->fs, &iter, x*scale, y*scale, string, end, FONS_GLYPH_BITMAP_REQUIRED);
-	prevIter = iter;
+	// The glyphs of a string can take pages from glyphs drawn before it,
+	// but not from each other, so earlier quads stay valid while iterating.
+	fonsTextIterInit(ctx->fs, &iter, fracx, fracy, string, end, FONS_GLYPH_BITMAP_REQUIRED);
 	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
-		float c[4*2];
-		if (iter.prevGlyphIndex == -1) { // can not retrieve glyph?
-			if (nverts != 0) {
-				nvg__renderText(ctx, verts, nverts);
-				nverts = 0;
-			}
-			if (!nvg__allocTextAtlas(ctx))
-				break; // no memory :(
-			iter = prevIter;
-			fonsTextIterNext(ctx->fs, &iter, &q); // try again
-			if (iter.prevGlyphIndex == -1) // still can not find glyph?
-				break;
-		}
-		prevIter = iter;
-		// Transform corners.
-		nvgTransformPoint(&c[0],&c[1], state->xform, q.x0*invscale, q.y0*invscale);
-		nvgTransformPoint(&c[2],&c[3], state->xform, q.x1*invscale, q.y0*invscale);
-		nvgTransformPoint(&c[4],&c[5], state->xform, q.x1*invscale, q.y1*invscale);
-		nvgTransformPoint(&c[6],&c[7], state->xform, q.x0*invscale, q.y1*invscale);
-		// Create triangles
-		if (nverts+6 <= cverts) {
-			nvg__vset(&verts[nverts], c[0], c[1], q.s0, q.t0); nverts++;
-			nvg__vset(&verts[nverts], c[4], c[5], q.s1, q.t1); nverts++;
-			nvg__vset(&verts[nverts], c[2], c[3], q.s1, q.t0); nverts++;
-			nvg__vset(&verts[nverts], c[0], c[1], q.s0, q.t0); nverts++;
-			nvg__vset(&verts[nverts], c[6], c[7], q.s0, q.t1); nverts++;
-			nvg__vset(&verts[nverts], c[4], c[5], q.s1, q.t1); nverts++;
+		if (iter.prevGlyphIndex == -1) // can not retrieve glyph?
+			break;
+		if (iter.pending) // drawn with a stand-in until it's rasterized
+			run = NULL;
+		if (run != NULL && !nvg__textRunAddQuad(run, &q, iter.cacheIndex))
+			run = NULL;
+		if (q.page != page) {
+			nvg__flushTextTexture(ctx);
+			nvg__renderText(ctx, verts, nverts, page);
+			verts += nverts;
+			cverts -= nverts;
+			nverts = 0;
+			page = q.page;
 		}
+		if (nverts+6 <= cverts)
+			nverts += nvg__textQuadVerts(&verts[nverts], state->xform, &q, originx, originy, invscale);
+	}
+	nvg__syncFontAtlas(ctx);
+
+	// The run is only used once it holds every quad of the string
+	if (run != NULL && iter.next == end) {
+		run->advance = iter.nextx;
+		run->fontAtlasGeneration = ctx->fontAtlasGeneration;
+		run->valid = 1;
+		run->lastUsed = ++ctx->textRunClock;
 	}
 
 	// TODO: add back-end bit to do this just once per frame.
 	nvg__flushTextTexture(ctx);
 
-	nvg__renderText(ctx, verts, nverts);
+	nvg__renderText(ctx, verts, nverts, page);
 
-	return iter.nextx / scale;
+	return (originx + iter.nextx) * invscale;
 }
 
 void nvgTextBox(NVGcontext* ctx, float x, float y, float breakRowWidth, const char* string, const char* end)
@@ -2554,7 +2918,7 @@ int nvgTextGlyphPositions(NVGcontext* ctx, float x, float y, const char* string,
 	NVGstate* state = nvg__getState(ctx);
 	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
 	float invscale = 1.0f / scale;
-	FONStextIter iter, prevIter;
+	FONStextIter iter;
 	FONSquad q;
 	int npos = 0;
 
@@ -2573,13 +2937,7 @@ int nvgTextGlyphPositions(NVGcontext* ctx, float x, float y, const char* string,
 	fonsSetFont(ctx->fs, state->fontId);
 
 	fonsTextIterInit(ctx->fs, &iter, x*scale, y*scale, string, end, FONS_GLYPH_BITMAP_OPTIONAL);
-	prevIter = iter;
 	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
-		if (iter.prevGlyphIndex < 0 && nvg__allocTextAtlas(ctx)) { // can not retrieve glyph?
-			iter = prevIter;
-			fonsTextIterNext(ctx->fs, &iter, &q); // try again
-		}
-		prevIter = iter;
 		positions[npos].str = iter.str;
 		positions[npos].x = iter.x * invscale;
 		positions[npos].minx = nvg__minf(iter.x, q.x0) * invscale;
@@ -2604,7 +2962,7 @@ int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, floa
 	NVGstate* state = nvg__getState(ctx);
 	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
 	float invscale = 1.0f / scale;
-	FONStextIter iter, prevIter;
+	FONStextIter iter;
 	FONSquad q;
 	int nrows = 0;
 	float rowStartX = 0;
@@ -2639,13 +2997,7 @@ int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, floa
 	breakRowWidth *= scale;
 
 	fonsTextIterInit(ctx->fs, &iter, 0, 0, string, end, FONS_GLYPH_BITMAP_OPTIONAL);
-	prevIter = iter;
 	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
-		if (iter.prevGlyphIndex < 0 && nvg__allocTextAtlas(ctx)) { // can not retrieve glyph?
-			iter = prevIter;
-			fonsTextIterNext(ctx->fs, &iter, &q); // try again
-		}
-		prevIter = iter;
 		switch (iter.codepoint) {
 			case 9:			// \t
 			case 11:		// \v
@@ -441,6 +441,14 @@ void nvgIntersectScissor(NVGcontext* ctx, float x, float y, float w, float h);
 // Reset and disables scissoring.
 void nvgResetScissor(NVGcontext* ctx);
 
+// Sets the cull rectangle, in screen space. Fills and strokes whose bounds fall
+// completely outside of it are dropped before they are tessellated. Unlike the
+// scissor, the cull rectangle is not part of the state and does not clip anything.
+void nvgCullRect(NVGcontext* ctx, float x, float y, float w, float h);
+
+// Disables the cull rectangle.
+void nvgResetCullRect(NVGcontext* ctx);
+
 //
 // Paths
 //
@@ -571,6 +579,26 @@ void nvgResetFallbackFontsId(NVGcontext* ctx, int baseFont);
 // Resets fallback fonts by name.
 void nvgResetFallbackFonts(NVGcontext* ctx, const char* baseFont);
 
+// Sets how many bytes of glyph textures the font atlas may keep, 4 MB by
+// default. The atlas grows a page at a time, and once it reaches the budget
+// the glyphs of the page drawn from least are evicted to make room. A frame
+// that draws more than fits goes over the budget until it ends.
+void nvgFontAtlasBudget(NVGcontext* ctx, int bytes);
+
+struct NVGfontAtlasStats {
+	int pages;			// Pages in the atlas
+	int maxPages;		// Pages that fit the budget
+	int bytes;			// Bytes of glyph textures
+	int glyphs;			// Glyphs rasterized into the atlas
+	int evictedGlyphs;	// Glyphs evicted since the atlas was created
+	int evictedPages;	// Pages evicted since the atlas was created
+	int glyphMisses;	// Glyph lookups that missed since the atlas was created
+	int pendingGlyphs;	// Glyphs handed to a glyph job callback and not yet finished
+};
+typedef struct NVGfontAtlasStats NVGfontAtlasStats;
+
+void nvgFontAtlasStats(NVGcontext* ctx, NVGfontAtlasStats* stats);
+
 // Sets the font size of current text style.
 void nvgFontSize(NVGcontext* ctx, float size);
 
@@ -657,9 +685,24 @@ struct NVGpath {
 };
 typedef struct NVGpath NVGpath;
 
+// Counters of the work a render back-end has sent to the GPU. Back-ends
+// count what they actually upload on renderFlush, so cancelled frames and
+// frames skipped as unchanged don't count.
+struct NVGrenderStats {
+	int calls;			// Fill, stroke and triangle calls flushed
+	int vertices;		// Vertices uploaded
+	int uniformBytes;	// Fragment uniform bytes uploaded
+	int textureBytes;	// Texture bytes uploaded, including font atlas updates
+	int convexFills;	// Fills drawn directly
+	int stencilFills;	// Fills drawn through the stencil buffer
+	int glyphMisses;	// Glyph lookups that missed the font cache
+};
+typedef struct NVGrenderStats NVGrenderStats;
+
 struct NVGparams {
 	void* userPtr;
 	int edgeAntiAlias;
+	NVGrenderStats* renderStats; // Kept by the back-end, or NULL
 	int (*renderCreate)(void* uptr);
 	int (*renderCreateTexture)(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data);
 	int (*renderDeleteTexture)(void* uptr, int image);
@@ -681,6 +724,63 @@ void nvgDeleteInternal(NVGcontext* ctx);
 
 NVGparams* nvgInternalParams(NVGcontext* ctx);
 
+// Returns the render counters, which keep counting until they are reset
+// by the caller. Back-ends that don't count still report glyph misses.
+NVGrenderStats* nvgInternalRenderStats(NVGcontext* ctx);
+
+// Returns a counter that is incremented every time glyphs are evicted from
+// the font atlas, or arrive from a glyph job. Text vertices kept across
+// frames are only valid while it stays the same.
+int nvgInternalFontAtlasGeneration(NVGcontext* ctx);
+
+// Marks the font atlas page behind an image as drawn this frame, so that
+// its glyphs aren't evicted before the frame ends. For callers that draw
+// text from vertices they kept.
+void nvgInternalTouchFontImage(NVGcontext* ctx, int image);
+
+// Hands glyphs that have to be rasterized to a callback as jobs, instead
+// of rasterizing them while drawing text, or takes them back with NULL.
+// Jobs are rasterized with nvgInternalRasterizeGlyphJob() on any thread,
+// and finished with nvgInternalFinishGlyphJob() on the thread that draws,
+// which puts the glyph in the font atlas and frees the job. Every job has
+// to be finished before the context is deleted. Until then, text is drawn
+// with the glyph at another size, or without it.
+struct FONSglyphJob;
+void nvgInternalGlyphJobCallback(NVGcontext* ctx, void (*callback)(void* uptr, struct FONSglyphJob* job), void* uptr);
+void nvgInternalRasterizeGlyphJob(struct FONSglyphJob* job);
+// Returns the bytes the glyph of a job takes in the font atlas.
+int nvgInternalGlyphJobSize(struct FONSglyphJob* job);
+// Returns 0 if the glyph was evicted from the font atlas in the meantime.
+int nvgInternalFinishGlyphJob(NVGcontext* ctx, struct FONSglyphJob* job);
+
+// Saves the glyphs in the font atlas, to be loaded back into a context
+// that has the same fonts before it draws any text. Returns data to be
+// freed with free(), or NULL.
+unsigned char* nvgInternalSaveFontAtlas(NVGcontext* ctx, int* size);
+// Returns the number of glyphs loaded.
+int nvgInternalLoadFontAtlas(NVGcontext* ctx, const unsigned char* data, int size);
+
+// Puts the glyphs of a string into the font atlas, at the size text of
+// the given size is drawn at the given device pixel ratio.
+void nvgInternalPrewarmGlyphs(NVGcontext* ctx, int font, float size, float pixelRatio, const char* string, const char* end);
+
+// The current state that text measurements depend on, for callers that cache
+// them. The font generation is incremented every time a font or a fallback
+// font is added or reset, which can change how existing strings measure.
+struct NVGtextState {
+	int fontId;
+	float fontSize;
+	float letterSpacing;
+	float lineHeight;
+	float fontBlur;
+	int textAlign;
+	float scale;
+	int fontGeneration;
+};
+typedef struct NVGtextState NVGtextState;
+
+void nvgInternalTextState(NVGcontext* ctx, NVGtextState* textState);
+
 // Debug function to dump cached path data.
 void nvgDebugDumpPathCache(NVGcontext* ctx);
 
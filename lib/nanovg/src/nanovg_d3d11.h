@@ -196,6 +196,8 @@ struct D3DNVGcontext {
 	int cuniforms;
 	int nuniforms;
 
+	NVGrenderStats stats;
+
 	// D3D
 	// Geometry
 	struct D3DNVGBuffer VertexBuffer;
@@ -655,6 +657,7 @@ static int D3Dnvg__renderCreateTexture(void* uptr, int type, int w, int h, int i
 	if (data != NULL)
 	{
 		D3D_API_6(D3D->pDeviceContext, UpdateSubresource, (ID3D11Resource*)tex->tex, 0, NULL, data, tex->width * pixelWidthBytes, (tex->width * tex->height) * pixelWidthBytes);
+		D3D->stats.textureBytes += tex->width * tex->height * pixelWidthBytes;
 	}
 
 	viewDesc.Format = texDesc.Format;
@@ -712,6 +715,7 @@ static int D3Dnvg__renderUpdateTexture(void* uptr, int image, int x, int y, int
 
 	pData = (unsigned char*)data + (y * (tex->width * pixelWidthBytes)) + (x * pixelWidthBytes);
 	D3D_API_6(D3D->pDeviceContext, UpdateSubresource, (ID3D11Resource*)tex->tex, 0, &box, pData, tex->width, tex->width * tex->height);
+	D3D->stats.textureBytes += w * h * pixelWidthBytes;
 
 	return 1;
 }
@@ -1051,6 +1055,10 @@ static void D3Dnvg__renderFlush(void* uptr)
 		unsigned int buffer0Offset = D3Dnvg_updateVertexBuffer(D3D->pDeviceContext, &D3D->VertexBuffer, D3D->verts, D3D->nverts);
 		D3Dnvg_setBuffers(D3D, buffer0Offset);
 
+		D3D->stats.calls += D3D->ncalls;
+		D3D->stats.vertices += D3D->nverts;
+		D3D->stats.uniformBytes += D3D->nuniforms * D3D->fragSize;
+
 		// Ensure valid state
 		D3D_API_3(D3D->pDeviceContext, PSSetConstantBuffers, 0, 1, &D3D->pPSConstants);
 		D3D_API_3(D3D->pDeviceContext, VSSetConstantBuffers, 0, 1, &D3D->pVSConstants);
@@ -1076,6 +1084,11 @@ static void D3Dnvg__renderFlush(void* uptr)
 				}
 			}
 
+			if (call->type == D3DNVG_FILL)
+				D3D->stats.stencilFills++;
+			else if (call->type == D3DNVG_CONVEXFILL)
+				D3D->stats.convexFills++;
+
 			if (call->type == D3DNVG_FILL)
 				D3Dnvg__fill(D3D, call);
 			else if (call->type == D3DNVG_CONVEXFILL)
@@ -1437,6 +1450,7 @@ struct NVGcontext* nvgCreateD3D11(ID3D11Device* pDevice, int flags)
 	params.renderDelete = D3Dnvg__renderDelete;
 	params.userPtr = D3D;
 	params.edgeAntiAlias = flags & NVG_ANTIALIAS ? 1 : 0;
+	params.renderStats = &D3D->stats;
 
 	D3D->flags = flags;
 
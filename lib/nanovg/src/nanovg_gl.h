@@ -32,6 +32,10 @@ enum NVGcreateFlags {
 	NVG_STENCIL_STROKES	= 1<<1,
 	// Flag indicating that additional debug checks are done.
 	NVG_DEBUG 			= 1<<2,
+	// Flag indicating that a flush is skipped when its calls, vertices and uniforms are identical
+	// to those of the previous flush and no texture has changed in between. Textures that are
+	// updated outside of NanoVG (see nvglCreateImageFromHandle) are not noticed.
+	NVG_SKIP_UNCHANGED_FRAMES	= 1<<3,
 };
 
 #if defined NANOVG_GL2_IMPLEMENTATION
@@ -61,6 +65,8 @@ void nvgDeleteGL2(NVGcontext* ctx);
 
 int nvglCreateImageFromHandleGL2(NVGcontext* ctx, GLuint textureId, int w, int h, int flags);
 GLuint nvglImageHandleGL2(NVGcontext* ctx, int image);
+void nvglClearRectGL2(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color);
+int nvglFrameSkippedGL2(NVGcontext* ctx);
 
 #endif
 
@@ -71,6 +77,8 @@ void nvgDeleteGL3(NVGcontext* ctx);
 
 int nvglCreateImageFromHandleGL3(NVGcontext* ctx, GLuint textureId, int w, int h, int flags);
 GLuint nvglImageHandleGL3(NVGcontext* ctx, int image);
+void nvglClearRectGL3(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color);
+int nvglFrameSkippedGL3(NVGcontext* ctx);
 
 #endif
 
@@ -81,6 +89,8 @@ void nvgDeleteGLES2(NVGcontext* ctx);
 
 int nvglCreateImageFromHandleGLES2(NVGcontext* ctx, GLuint textureId, int w, int h, int flags);
 GLuint nvglImageHandleGLES2(NVGcontext* ctx, int image);
+void nvglClearRectGLES2(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color);
+int nvglFrameSkippedGLES2(NVGcontext* ctx);
 
 #endif
 
@@ -91,9 +101,16 @@ void nvgDeleteGLES3(NVGcontext* ctx);
 
 int nvglCreateImageFromHandleGLES3(NVGcontext* ctx, GLuint textureId, int w, int h, int flags);
 GLuint nvglImageHandleGLES3(NVGcontext* ctx, int image);
+void nvglClearRectGLES3(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color);
+int nvglFrameSkippedGLES3(NVGcontext* ctx);
 
 #endif
 
+// nvglClearRect() clears a rectangle of the framebuffer, in pixels with the origin at the bottom-left,
+// at the start of the next flush. Clearing as part of the flush means that a skipped frame
+// leaves the framebuffer untouched.
+// nvglFrameSkipped() returns 1 if the last flush was skipped, see NVG_SKIP_UNCHANGED_FRAMES.
+
 // These are additional flags on top of NVGimageFlags.
 enum NVGimageFlagsGL {
 	NVG_IMAGE_NODELETE			= 1<<16,	// Do not delete GL texture handle.
@@ -259,6 +276,18 @@ struct GLNVGcontext {
 	int cuniforms;
 	int nuniforms;
 
+	// Clear done at the start of the flush
+	int clear;
+	int clearRect[4];
+	NVGcolor clearColor;
+
+	// Skipping of unchanged frames
+	unsigned long long frameHash;
+	int texturesChanged;
+	int frameSkipped;
+
+	NVGrenderStats stats;
+
 	// cached state
 	#if NANOVG_GL_USE_STATE_FILTER
 	GLuint boundTexture;
@@ -713,6 +742,7 @@ static int glnvg__renderCreateTexture(void* uptr, int type, int w, int h, int im
 	GLNVGtexture* tex = glnvg__allocTexture(gl);
 
 	if (tex == NULL) return 0;
+	gl->texturesChanged = 1;
 
 #ifdef NANOVG_GLES2
 	// Check for non-power of 2.
@@ -751,6 +781,9 @@ static int glnvg__renderCreateTexture(void* uptr, int type, int w, int h, int im
 	}
 #endif
 
+	if (data != NULL)
+		gl->stats.textureBytes += w * h * (type == NVG_TEXTURE_RGBA ? 4 : 1);
+
 	if (type == NVG_TEXTURE_RGBA)
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 	else
@@ -816,6 +849,7 @@ static int glnvg__renderCreateTexture(void* uptr, int type, int w, int h, int im
 static int glnvg__renderDeleteTexture(void* uptr, int image)
 {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+	gl->texturesChanged = 1;
 	return glnvg__deleteTexture(gl, image);
 }
 
@@ -825,6 +859,7 @@ static int glnvg__renderUpdateTexture(void* uptr, int image, int x, int y, int w
 	GLNVGtexture* tex = glnvg__findTexture(gl, image);
 
 	if (tex == NULL) return 0;
+	gl->texturesChanged = 1;
 	glnvg__bindTexture(gl, tex->tex);
 
 	glPixelStorei(GL_UNPACK_ALIGNMENT,1);
@@ -843,6 +878,8 @@ static int glnvg__renderUpdateTexture(void* uptr, int image, int x, int y, int w
 	w = tex->width;
 #endif
 
+	gl->stats.textureBytes += w * h * (tex->type == NVG_TEXTURE_RGBA ? 4 : 1);
+
 	if (tex->type == NVG_TEXTURE_RGBA)
 		glTexSubImage2D(GL_TEXTURE_2D, 0, x,y, w,h, GL_RGBA, GL_UNSIGNED_BYTE, data);
 	else
@@ -1119,6 +1156,42 @@ static void glnvg__renderCancel(void* uptr) {
 	gl->npaths = 0;
 	gl->ncalls = 0;
 	gl->nuniforms = 0;
+	gl->clear = 0;
+}
+
+static unsigned long long glnvg__hash(unsigned long long h, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	size_t i, nwords = size / 4;
+	for (i = 0; i < nwords; i++) {
+		unsigned int word;
+		memcpy(&word, bytes + i*4, 4);
+		h = (h ^ word) * 0x100000001b3ULL;
+		h ^= h >> 29;
+	}
+	for (i = nwords*4; i < size; i++)
+		h = (h ^ bytes[i]) * 0x100000001b3ULL;
+	return h;
+}
+
+// Hashes everything a flush draws from: the view, the clear, the calls
+// and their paths, vertices and uniforms.
+static unsigned long long glnvg__hashFrame(GLNVGcontext* gl)
+{
+	unsigned long long h = 0xcbf29ce484222325ULL;
+	int i;
+	h = glnvg__hash(h, gl->view, sizeof(gl->view));
+	h = glnvg__hash(h, &gl->clear, sizeof(gl->clear));
+	if (gl->clear) {
+		h = glnvg__hash(h, gl->clearRect, sizeof(gl->clearRect));
+		h = glnvg__hash(h, &gl->clearColor, sizeof(gl->clearColor));
+	}
+	h = glnvg__hash(h, gl->calls, sizeof(GLNVGcall) * gl->ncalls);
+	h = glnvg__hash(h, gl->paths, sizeof(GLNVGpath) * gl->npaths);
+	h = glnvg__hash(h, gl->verts, sizeof(NVGvertex) * gl->nverts);
+	for (i = 0; i < gl->nuniforms; i++)
+		h = glnvg__hash(h, &gl->uniforms[i * gl->fragSize], sizeof(GLNVGfragUniforms));
+	return h;
 }
 
 static GLenum glnvg_convertBlendFuncFactor(int factor)
@@ -1170,8 +1243,37 @@ static void glnvg__renderFlush(void* uptr)
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
 	int i;
 
+	gl->frameSkipped = 0;
+	if (gl->flags & NVG_SKIP_UNCHANGED_FRAMES) {
+		unsigned long long hash = glnvg__hashFrame(gl);
+		if (hash == gl->frameHash && !gl->texturesChanged) {
+			gl->frameSkipped = 1;
+			gl->clear = 0;
+			gl->nverts = 0;
+			gl->npaths = 0;
+			gl->ncalls = 0;
+			gl->nuniforms = 0;
+			return;
+		}
+		gl->frameHash = hash;
+		gl->texturesChanged = 0;
+	}
+
+	if (gl->clear) {
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(gl->clearRect[0], gl->clearRect[1], gl->clearRect[2], gl->clearRect[3]);
+		glClearColor(gl->clearColor.r, gl->clearColor.g, gl->clearColor.b, gl->clearColor.a);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+		glDisable(GL_SCISSOR_TEST);
+		gl->clear = 0;
+	}
+
 	if (gl->ncalls > 0) {
 
+		gl->stats.calls += gl->ncalls;
+		gl->stats.vertices += gl->nverts;
+		gl->stats.uniformBytes += gl->nuniforms * gl->fragSize;
+
 		// Setup require GL state.
 		glUseProgram(gl->shader.prog);
 
@@ -1227,6 +1329,10 @@ static void glnvg__renderFlush(void* uptr)
 		for (i = 0; i < gl->ncalls; i++) {
 			GLNVGcall* call = &gl->calls[i];
 			glnvg__blendFuncSeparate(gl,&call->blendFunc);
+			if (call->type == GLNVG_FILL)
+				gl->stats.stencilFills++;
+			else if (call->type == GLNVG_CONVEXFILL)
+				gl->stats.convexFills++;
 			if (call->type == GLNVG_FILL)
 				glnvg__fill(gl, call);
 			else if (call->type == GLNVG_CONVEXFILL)
@@ -1580,6 +1686,7 @@ NVGcontext* nvgCreateGLES3(int flags)
 	params.renderDelete = glnvg__renderDelete;
 	params.userPtr = gl;
 	params.edgeAntiAlias = flags & NVG_ANTIALIAS ? 1 : 0;
+	params.renderStats = &gl->stats;
 
 	gl->flags = flags;
 
@@ -1646,4 +1753,37 @@ GLuint nvglImageHandleGLES3(NVGcontext* ctx, int image)
 	return tex->tex;
 }
 
+#if defined NANOVG_GL2
+void nvglClearRectGL2(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color)
+#elif defined NANOVG_GL3
+void nvglClearRectGL3(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color)
+#elif defined NANOVG_GLES2
+void nvglClearRectGLES2(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color)
+#elif defined NANOVG_GLES3
+void nvglClearRectGLES3(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color)
+#endif
+{
+	GLNVGcontext* gl = (GLNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	gl->clear = 1;
+	gl->clearRect[0] = x;
+	gl->clearRect[1] = y;
+	gl->clearRect[2] = w;
+	gl->clearRect[3] = h;
+	gl->clearColor = color;
+}
+
+#if defined NANOVG_GL2
+int nvglFrameSkippedGL2(NVGcontext* ctx)
+#elif defined NANOVG_GL3
+int nvglFrameSkippedGL3(NVGcontext* ctx)
+#elif defined NANOVG_GLES2
+int nvglFrameSkippedGLES2(NVGcontext* ctx)
+#elif defined NANOVG_GLES3
+int nvglFrameSkippedGLES3(NVGcontext* ctx)
+#endif
+{
+	GLNVGcontext* gl = (GLNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	return gl->frameSkipped;
+}
+
 #endif /* NANOVG_GL_IMPLEMENTATION */
@@ -0,0 +1,1245 @@
+//
+// Copyright (c) 2009-2013 Mikko Mononen memon@inside.org
+// Software rasterizer port of _gl.h
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef NANOVG_SW_H
+#define NANOVG_SW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The software renderer rasterizes the same calls the GL3 renderer would
+// draw into an RGBA8 framebuffer in memory. It emulates the GL pipeline
+// used by nanovg_gl.h (stencil fills, anti-aliased fringes, back-face
+// culling, the fragment shader and blending), so frames come out close
+// to what the GPU produces and can be compared pixel by pixel.
+
+// Create flags
+
+enum NVGswCreateFlags {
+	// Flag indicating if geometry based anti-aliasing is used.
+	NVGSW_ANTIALIAS 		= 1<<0,
+	// Flag indicating if strokes should be drawn using the stencil buffer,
+	// so that path overlaps are drawn just once.
+	NVGSW_STENCIL_STROKES	= 1<<1,
+};
+
+NVGcontext* nvgCreateSW(int flags);
+void nvgDeleteSW(NVGcontext* ctx);
+
+// Resizes the framebuffer to width x height pixels and clears it to color.
+void nvgswClear(NVGcontext* ctx, int width, int height, NVGcolor color);
+
+// Clears a rectangle of the framebuffer to color, leaving the rest untouched.
+// The rectangle is in pixels, with the origin at the top-left corner.
+void nvgswClearRect(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color);
+
+// Returns the framebuffer as tightly packed RGBA8 rows, top row first.
+// The pointer stays valid until the next call to nvgswClear().
+const unsigned char* nvgswFramebuffer(NVGcontext* ctx, int* width, int* height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOVG_SW_H */
+
+#ifdef NANOVG_SW_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "nanovg.h"
+
+enum SWNVGshaderType {
+	SWNVG_SHADER_FILLGRAD,
+	SWNVG_SHADER_FILLIMG,
+	SWNVG_SHADER_SIMPLE,
+	SWNVG_SHADER_IMG
+};
+
+enum SWNVGcallType {
+	SWNVG_NONE = 0,
+	SWNVG_FILL,
+	SWNVG_CONVEXFILL,
+	SWNVG_STROKE,
+	SWNVG_TRIANGLES,
+};
+
+// Stencil functions and operations, named after their GL counterparts.
+enum SWNVGstencilFunc {
+	SWNVG_ALWAYS,
+	SWNVG_EQUAL,
+	SWNVG_NOTEQUAL,
+};
+
+enum SWNVGstencilOp {
+	SWNVG_KEEP,
+	SWNVG_ZERO,
+	SWNVG_INCR,
+	SWNVG_INCR_WRAP_FRONT_DECR_WRAP_BACK,
+};
+
+struct SWNVGtexture {
+	int id;
+	unsigned char* data;
+	int width, height;
+	int type;
+	int flags;
+};
+typedef struct SWNVGtexture SWNVGtexture;
+
+struct SWNVGcall {
+	int type;
+	int image;
+	int pathOffset;
+	int pathCount;
+	int triangleOffset;
+	int triangleCount;
+	int uniformOffset;
+	NVGcompositeOperationState blendFunc;
+};
+typedef struct SWNVGcall SWNVGcall;
+
+struct SWNVGpath {
+	int fillOffset;
+	int fillCount;
+	int strokeOffset;
+	int strokeCount;
+};
+typedef struct SWNVGpath SWNVGpath;
+
+struct SWNVGfragUniforms {
+	float scissorMat[6];
+	float paintMat[6];
+	NVGcolor innerCol;
+	NVGcolor outerCol;
+	float scissorExt[2];
+	float scissorScale[2];
+	float extent[2];
+	float radius;
+	float feather;
+	float strokeMult;
+	float strokeThr;
+	int texType;
+	int type;
+};
+typedef struct SWNVGfragUniforms SWNVGfragUniforms;
+
+// Per draw state, the software equivalent of the GL state nanovg_gl.h sets.
+struct SWNVGdrawState {
+	SWNVGfragUniforms* frag;
+	SWNVGtexture* tex;
+	NVGcompositeOperationState blend;
+	int cull;
+	int colorWrite;
+	int stencilFunc;
+	int stencilOp;
+};
+typedef struct SWNVGdrawState SWNVGdrawState;
+
+struct SWNVGcontext {
+	SWNVGtexture* textures;
+	float view[2];
+	int ntextures;
+	int ctextures;
+	int textureId;
+	int flags;
+
+	// Framebuffer
+	unsigned char* pixels;
+	unsigned char* stencil;
+	int width, height;
+
+	// Per frame buffers
+	SWNVGcall* calls;
+	int ccalls;
+	int ncalls;
+	SWNVGpath* paths;
+	int cpaths;
+	int npaths;
+	struct NVGvertex* verts;
+	int cverts;
+	int nverts;
+	SWNVGfragUniforms* uniforms;
+	int cuniforms;
+	int nuniforms;
+
+	NVGrenderStats stats;
+};
+typedef struct SWNVGcontext SWNVGcontext;
+
+static int swnvg__maxi(int a, int b) { return a > b ? a : b; }
+static int swnvg__mini(int a, int b) { return a < b ? a : b; }
+static float swnvg__clampf(float a, float mn, float mx) { return a < mn ? mn : (a > mx ? mx : a); }
+static float swnvg__minf3(float a, float b, float c) { return a < b ? (a < c ? a : c) : (b < c ? b : c); }
+static float swnvg__maxf3(float a, float b, float c) { return a > b ? (a > c ? a : c) : (b > c ? b : c); }
+
+static SWNVGtexture* swnvg__allocTexture(SWNVGcontext* sw)
+{
+	SWNVGtexture* tex = NULL;
+	int i;
+
+	for (i = 0; i < sw->ntextures; i++) {
+		if (sw->textures[i].id == 0) {
+			tex = &sw->textures[i];
+			break;
+		}
+	}
+	if (tex == NULL) {
+		if (sw->ntextures+1 > sw->ctextures) {
+			SWNVGtexture* textures;
+			int ctextures = swnvg__maxi(sw->ntextures+1, 4) +  sw->ctextures/2; // 1.5x Overallocate
+			textures = (SWNVGtexture*)realloc(sw->textures, sizeof(SWNVGtexture)*ctextures);
+			if (textures == NULL) return NULL;
+			sw->textures = textures;
+			sw->ctextures = ctextures;
+		}
+		tex = &sw->textures[sw->ntextures++];
+	}
+
+	memset(tex, 0, sizeof(*tex));
+	tex->id = ++sw->textureId;
+
+	return tex;
+}
+
+static SWNVGtexture* swnvg__findTexture(SWNVGcontext* sw, int id)
+{
+	int i;
+	for (i = 0; i < sw->ntextures; i++)
+		if (sw->textures[i].id == id)
+			return &sw->textures[i];
+	return NULL;
+}
+
+static int swnvg__deleteTexture(SWNVGcontext* sw, int id)
+{
+	int i;
+	for (i = 0; i < sw->ntextures; i++) {
+		if (sw->textures[i].id == id) {
+			free(sw->textures[i].data);
+			memset(&sw->textures[i], 0, sizeof(sw->textures[i]));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int swnvg__renderCreate(void* uptr)
+{
+	NVG_NOTUSED(uptr);
+	return 1;
+}
+
+static int swnvg__bytesPerPixel(int type)
+{
+	return type == NVG_TEXTURE_RGBA ? 4 : 1;
+}
+
+static int swnvg__renderCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGtexture* tex = swnvg__allocTexture(sw);
+	int size = w * h * swnvg__bytesPerPixel(type);
+
+	if (tex == NULL) return 0;
+
+	tex->data = (unsigned char*)malloc(size);
+	if (tex->data == NULL) {
+		tex->id = 0;
+		return 0;
+	}
+	if (data != NULL) {
+		memcpy(tex->data, data, size);
+		sw->stats.textureBytes += size;
+	} else
+		memset(tex->data, 0, size);
+
+	tex->width = w;
+	tex->height = h;
+	tex->type = type;
+	tex->flags = imageFlags;
+
+	return tex->id;
+}
+
+static int swnvg__renderDeleteTexture(void* uptr, int image)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	return swnvg__deleteTexture(sw, image);
+}
+
+static int swnvg__renderUpdateTexture(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGtexture* tex = swnvg__findTexture(sw, image);
+	int bpp, row;
+
+	if (tex == NULL) return 0;
+
+	// Like glTexSubImage2D with GL_UNPACK_ROW_LENGTH set to the texture width,
+	// data points at the whole image and the region is picked out of it.
+	bpp = swnvg__bytesPerPixel(tex->type);
+	for (row = y; row < y + h; row++) {
+		int offset = (row * tex->width + x) * bpp;
+		memcpy(&tex->data[offset], &data[offset], w * bpp);
+	}
+	sw->stats.textureBytes += w * h * bpp;
+
+	return 1;
+}
+
+static int swnvg__renderGetTextureSize(void* uptr, int image, int* w, int* h)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGtexture* tex = swnvg__findTexture(sw, image);
+	if (tex == NULL) return 0;
+	*w = tex->width;
+	*h = tex->height;
+	return 1;
+}
+
+static NVGcolor swnvg__premulColor(NVGcolor c)
+{
+	c.r *= c.a;
+	c.g *= c.a;
+	c.b *= c.a;
+	return c;
+}
+
+static int swnvg__convertPaint(SWNVGcontext* sw, SWNVGfragUniforms* frag, NVGpaint* paint,
+							   NVGscissor* scissor, float width, float fringe, float strokeThr)
+{
+	SWNVGtexture* tex = NULL;
+
+	memset(frag, 0, sizeof(*frag));
+
+	frag->innerCol = swnvg__premulColor(paint->innerColor);
+	frag->outerCol = swnvg__premulColor(paint->outerColor);
+
+	if (scissor->extent[0] < -0.5f || scissor->extent[1] < -0.5f) {
+		memset(frag->scissorMat, 0, sizeof(frag->scissorMat));
+		frag->scissorExt[0] = 1.0f;
+		frag->scissorExt[1] = 1.0f;
+		frag->scissorScale[0] = 1.0f;
+		frag->scissorScale[1] = 1.0f;
+	} else {
+		nvgTransformInverse(frag->scissorMat, scissor->xform);
+		frag->scissorExt[0] = scissor->extent[0];
+		frag->scissorExt[1] = scissor->extent[1];
+		frag->scissorScale[0] = sqrtf(scissor->xform[0]*scissor->xform[0] + scissor->xform[2]*scissor->xform[2]) / fringe;
+		frag->scissorScale[1] = sqrtf(scissor->xform[1]*scissor->xform[1] + scissor->xform[3]*scissor->xform[3]) / fringe;
+	}
+
+	memcpy(frag->extent, paint->extent, sizeof(frag->extent));
+	frag->strokeMult = (width*0.5f + fringe*0.5f) / fringe;
+	frag->strokeThr = strokeThr;
+
+	if (paint->image != 0) {
+		tex = swnvg__findTexture(sw, paint->image);
+		if (tex == NULL) return 0;
+		if ((tex->flags & NVG_IMAGE_FLIPY) != 0) {
+			float m1[6], m2[6];
+			nvgTransformTranslate(m1, 0.0f, frag->extent[1] * 0.5f);
+			nvgTransformMultiply(m1, paint->xform);
+			nvgTransformScale(m2, 1.0f, -1.0f);
+			nvgTransformMultiply(m2, m1);
+			nvgTransformTranslate(m1, 0.0f, -frag->extent[1] * 0.5f);
+			nvgTransformMultiply(m1, m2);
+			nvgTransformInverse(frag->paintMat, m1);
+		} else {
+			nvgTransformInverse(frag->paintMat, paint->xform);
+		}
+		frag->type = SWNVG_SHADER_FILLIMG;
+
+		if (tex->type == NVG_TEXTURE_RGBA)
+			frag->texType = (tex->flags & NVG_IMAGE_PREMULTIPLIED) ? 0 : 1;
+		else
+			frag->texType = 2;
+	} else {
+		frag->type = SWNVG_SHADER_FILLGRAD;
+		frag->radius = paint->radius;
+		frag->feather = paint->feather;
+		nvgTransformInverse(frag->paintMat, paint->xform);
+	}
+
+	return 1;
+}
+
+static void swnvg__renderViewport(void* uptr, float width, float height, float devicePixelRatio)
+{
+	NVG_NOTUSED(devicePixelRatio);
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	sw->view[0] = width;
+	sw->view[1] = height;
+}
+
+//
+// Fragment shader
+//
+
+static float swnvg__sdroundrect(float px, float py, float ex, float ey, float rad)
+{
+	float dx = fabsf(px) - (ex - rad);
+	float dy = fabsf(py) - (ey - rad);
+	float mx = dx > 0.0f ? dx : 0.0f;
+	float my = dy > 0.0f ? dy : 0.0f;
+	float inside = dx > dy ? dx : dy;
+	if (inside > 0.0f) inside = 0.0f;
+	return inside + sqrtf(mx*mx + my*my) - rad;
+}
+
+static float swnvg__scissorMask(const SWNVGfragUniforms* frag, float x, float y)
+{
+	const float* m = frag->scissorMat;
+	float sx = fabsf(m[0]*x + m[2]*y + m[4]) - frag->scissorExt[0];
+	float sy = fabsf(m[1]*x + m[3]*y + m[5]) - frag->scissorExt[1];
+	sx = 0.5f - sx * frag->scissorScale[0];
+	sy = 0.5f - sy * frag->scissorScale[1];
+	return swnvg__clampf(sx, 0.0f, 1.0f) * swnvg__clampf(sy, 0.0f, 1.0f);
+}
+
+static void swnvg__texel(const SWNVGtexture* tex, int x, int y, float* out)
+{
+	const unsigned char* p;
+
+	if (tex->flags & NVG_IMAGE_REPEATX) {
+		x %= tex->width;
+		if (x < 0) x += tex->width;
+	} else {
+		x = swnvg__maxi(0, swnvg__mini(x, tex->width-1));
+	}
+	if (tex->flags & NVG_IMAGE_REPEATY) {
+		y %= tex->height;
+		if (y < 0) y += tex->height;
+	} else {
+		y = swnvg__maxi(0, swnvg__mini(y, tex->height-1));
+	}
+
+	if (tex->type == NVG_TEXTURE_RGBA) {
+		p = &tex->data[(y * tex->width + x) * 4];
+		out[0] = p[0] / 255.0f;
+		out[1] = p[1] / 255.0f;
+		out[2] = p[2] / 255.0f;
+		out[3] = p[3] / 255.0f;
+	} else {
+		// Single channel textures sample as (r, 0, 0, 1) like GL_RED
+		out[0] = tex->data[y * tex->width + x] / 255.0f;
+		out[1] = 0.0f;
+		out[2] = 0.0f;
+		out[3] = 1.0f;
+	}
+}
+
+// Samples with normalized coordinates, bilinear unless NVG_IMAGE_NEAREST is set.
+// Mipmaps are not emulated.
+static void swnvg__sample(const SWNVGtexture* tex, float u, float v, float* out)
+{
+	float fx, fy, ax, ay;
+	float t00[4], t10[4], t01[4], t11[4];
+	int x0, y0, i;
+
+	if (tex == NULL || tex->data == NULL) {
+		out[0] = out[1] = out[2] = out[3] = 0.0f;
+		return;
+	}
+
+	if (tex->flags & NVG_IMAGE_NEAREST) {
+		swnvg__texel(tex, (int)floorf(u * tex->width), (int)floorf(v * tex->height), out);
+		return;
+	}
+
+	fx = u * tex->width - 0.5f;
+	fy = v * tex->height - 0.5f;
+	x0 = (int)floorf(fx);
+	y0 = (int)floorf(fy);
+	ax = fx - x0;
+	ay = fy - y0;
+
+	swnvg__texel(tex, x0,   y0,   t00);
+	swnvg__texel(tex, x0+1, y0,   t10);
+	swnvg__texel(tex, x0,   y0+1, t01);
+	swnvg__texel(tex, x0+1, y0+1, t11);
+
+	for (i = 0; i < 4; i++) {
+		float top = t00[i] + (t10[i] - t00[i]) * ax;
+		float bottom = t01[i] + (t11[i] - t01[i]) * ax;
+		out[i] = top + (bottom - top) * ay;
+	}
+}
+
+static void swnvg__texColor(const SWNVGfragUniforms* frag, float* color)
+{
+	if (frag->texType == 1) {
+		color[0] *= color[3];
+		color[1] *= color[3];
+		color[2] *= color[3];
+	}
+	if (frag->texType == 2) {
+		color[1] = color[2] = color[3] = color[0];
+	}
+}
+
+// Mirrors the fill fragment shader of nanovg_gl.h. Returns 0 if the
+// fragment is discarded, otherwise writes the premultiplied color to out.
+static int swnvg__shade(SWNVGcontext* sw, const SWNVGdrawState* ds, float x, float y, float u, float v, float* out)
+{
+	const SWNVGfragUniforms* frag = ds->frag;
+	float scissor = swnvg__scissorMask(frag, x, y);
+	float strokeAlpha = 1.0f;
+	float color[4];
+	int i;
+
+	if (sw->flags & NVGSW_ANTIALIAS) {
+		strokeAlpha = (1.0f - fabsf(u*2.0f - 1.0f)) * frag->strokeMult;
+		if (strokeAlpha > 1.0f) strokeAlpha = 1.0f;
+		if (v < 1.0f) strokeAlpha *= v;
+		if (strokeAlpha < frag->strokeThr) return 0;
+	}
+
+	if (frag->type == SWNVG_SHADER_FILLGRAD) {
+		const float* m = frag->paintMat;
+		float px = m[0]*x + m[2]*y + m[4];
+		float py = m[1]*x + m[3]*y + m[5];
+		float d = swnvg__clampf((swnvg__sdroundrect(px, py, frag->extent[0], frag->extent[1], frag->radius) + frag->feather*0.5f) / frag->feather, 0.0f, 1.0f);
+		color[0] = frag->innerCol.r + (frag->outerCol.r - frag->innerCol.r) * d;
+		color[1] = frag->innerCol.g + (frag->outerCol.g - frag->innerCol.g) * d;
+		color[2] = frag->innerCol.b + (frag->outerCol.b - frag->innerCol.b) * d;
+		color[3] = frag->innerCol.a + (frag->outerCol.a - frag->innerCol.a) * d;
+		for (i = 0; i < 4; i++) out[i] = color[i] * strokeAlpha * scissor;
+	} else if (frag->type == SWNVG_SHADER_FILLIMG) {
+		const float* m = frag->paintMat;
+		float px = (m[0]*x + m[2]*y + m[4]) / frag->extent[0];
+		float py = (m[1]*x + m[3]*y + m[5]) / frag->extent[1];
+		swnvg__sample(ds->tex, px, py, color);
+		swnvg__texColor(frag, color);
+		color[0] *= frag->innerCol.r;
+		color[1] *= frag->innerCol.g;
+		color[2] *= frag->innerCol.b;
+		color[3] *= frag->innerCol.a;
+		for (i = 0; i < 4; i++) out[i] = color[i] * strokeAlpha * scissor;
+	} else if (frag->type == SWNVG_SHADER_SIMPLE) {
+		out[0] = out[1] = out[2] = out[3] = 1.0f;
+	} else {
+		swnvg__sample(ds->tex, u, v, color);
+		swnvg__texColor(frag, color);
+		out[0] = color[0] * scissor * frag->innerCol.r;
+		out[1] = color[1] * scissor * frag->innerCol.g;
+		out[2] = color[2] * scissor * frag->innerCol.b;
+		out[3] = color[3] * scissor * frag->innerCol.a;
+	}
+
+	return 1;
+}
+
+//
+// Blending
+//
+
+static float swnvg__blendFactor(int factor, const float* src, const float* dst, int channel)
+{
+	switch (factor) {
+		case NVG_ZERO: return 0.0f;
+		case NVG_ONE: return 1.0f;
+		case NVG_SRC_COLOR: return src[channel];
+		case NVG_ONE_MINUS_SRC_COLOR: return 1.0f - src[channel];
+		case NVG_DST_COLOR: return dst[channel];
+		case NVG_ONE_MINUS_DST_COLOR: return 1.0f - dst[channel];
+		case NVG_SRC_ALPHA: return src[3];
+		case NVG_ONE_MINUS_SRC_ALPHA: return 1.0f - src[3];
+		case NVG_DST_ALPHA: return dst[3];
+		case NVG_ONE_MINUS_DST_ALPHA: return 1.0f - dst[3];
+		case NVG_SRC_ALPHA_SATURATE:
+			if (channel == 3) return 1.0f;
+			return src[3] < 1.0f - dst[3] ? src[3] : 1.0f - dst[3];
+	}
+	return 0.0f;
+}
+
+static unsigned char swnvg__toByte(float c)
+{
+	return (unsigned char)(swnvg__clampf(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+static void swnvg__blend(const NVGcompositeOperationState* op, unsigned char* pixel, const float* src)
+{
+	float dst[4];
+	int i;
+
+	// Fast path for the default source-over operation.
+	if (op->srcRGB == NVG_ONE && op->dstRGB == NVG_ONE_MINUS_SRC_ALPHA &&
+		op->srcAlpha == NVG_ONE && op->dstAlpha == NVG_ONE_MINUS_SRC_ALPHA) {
+		float ia = 1.0f - src[3];
+		for (i = 0; i < 4; i++)
+			pixel[i] = swnvg__toByte(src[i] + (pixel[i] / 255.0f) * ia);
+		return;
+	}
+
+	for (i = 0; i < 4; i++)
+		dst[i] = pixel[i] / 255.0f;
+	for (i = 0; i < 3; i++)
+		pixel[i] = swnvg__toByte(src[i] * swnvg__blendFactor(op->srcRGB, src, dst, i) +
+								 dst[i] * swnvg__blendFactor(op->dstRGB, src, dst, i));
+	pixel[3] = swnvg__toByte(src[3] * swnvg__blendFactor(op->srcAlpha, src, dst, 3) +
+							 dst[3] * swnvg__blendFactor(op->dstAlpha, src, dst, 3));
+}
+
+static NVGcompositeOperationState swnvg__blendCompositeOperation(NVGcompositeOperationState op)
+{
+	int valid = NVG_ZERO | NVG_ONE | NVG_SRC_COLOR | NVG_ONE_MINUS_SRC_COLOR | NVG_DST_COLOR |
+				NVG_ONE_MINUS_DST_COLOR | NVG_SRC_ALPHA | NVG_ONE_MINUS_SRC_ALPHA | NVG_DST_ALPHA |
+				NVG_ONE_MINUS_DST_ALPHA | NVG_SRC_ALPHA_SATURATE;
+	if (op.srcRGB == 0 || op.dstRGB == 0 || op.srcAlpha == 0 || op.dstAlpha == 0 ||
+		(op.srcRGB & ~valid) || (op.dstRGB & ~valid) || (op.srcAlpha & ~valid) || (op.dstAlpha & ~valid))
+	{
+		op.srcRGB = NVG_ONE;
+		op.dstRGB = NVG_ONE_MINUS_SRC_ALPHA;
+		op.srcAlpha = NVG_ONE;
+		op.dstAlpha = NVG_ONE_MINUS_SRC_ALPHA;
+	}
+	return op;
+}
+
+//
+// Triangle rasterization
+//
+
+static int swnvg__stencilTest(int func, unsigned char value)
+{
+	if (func == SWNVG_EQUAL) return value == 0;
+	if (func == SWNVG_NOTEQUAL) return value != 0;
+	return 1;
+}
+
+static void swnvg__stencilApply(int op, unsigned char* value, int front)
+{
+	if (op == SWNVG_ZERO) *value = 0;
+	else if (op == SWNVG_INCR) { if (*value < 0xff) (*value)++; }
+	else if (op == SWNVG_INCR_WRAP_FRONT_DECR_WRAP_BACK) *value = (unsigned char)(front ? *value + 1 : *value - 1);
+}
+
+static void swnvg__rasterTriangle(SWNVGcontext* sw, const SWNVGdrawState* ds, const NVGvertex* v0, const NVGvertex* v1, const NVGvertex* v2)
+{
+	float sx = sw->width / sw->view[0];
+	float sy = sw->height / sw->view[1];
+	float x0 = v0->x * sx, y0 = v0->y * sy;
+	float x1 = v1->x * sx, y1 = v1->y * sy;
+	float x2 = v2->x * sx, y2 = v2->y * sy;
+	float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+	const NVGvertex* a = v0;
+	const NVGvertex* b = v1;
+	const NVGvertex* c = v2;
+	float ax, ay, bx, by, cx, cy;
+	int front, tl0, tl1, tl2, minx, miny, maxx, maxy, px, py;
+
+	if (area == 0.0f) return;
+
+	// Vertices arrive in logical coordinates and y points down, so a front
+	// facing (counter-clockwise in GL) triangle has a negative area here.
+	front = area < 0.0f;
+	if (ds->cull && !front) return;
+
+	// Reorder to a positive area so that inside means all edge functions >= 0.
+	if (area < 0.0f) {
+		b = v2;
+		c = v1;
+		area = -area;
+	}
+	ax = a->x * sx; ay = a->y * sy;
+	bx = b->x * sx; by = b->y * sy;
+	cx = c->x * sx; cy = c->y * sy;
+
+	// Top-left fill rule, so that shared edges are only covered once.
+	tl0 = (cy - by) < 0.0f || ((cy - by) == 0.0f && (cx - bx) > 0.0f);
+	tl1 = (ay - cy) < 0.0f || ((ay - cy) == 0.0f && (ax - cx) > 0.0f);
+	tl2 = (by - ay) < 0.0f || ((by - ay) == 0.0f && (bx - ax) > 0.0f);
+
+	minx = swnvg__maxi(0, (int)floorf(swnvg__minf3(ax, bx, cx)));
+	miny = swnvg__maxi(0, (int)floorf(swnvg__minf3(ay, by, cy)));
+	maxx = swnvg__mini(sw->width - 1, (int)ceilf(swnvg__maxf3(ax, bx, cx)));
+	maxy = swnvg__mini(sw->height - 1, (int)ceilf(swnvg__maxf3(ay, by, cy)));
+
+	for (py = miny; py <= maxy; py++) {
+		float fy = py + 0.5f;
+		for (px = minx; px <= maxx; px++) {
+			float fx = px + 0.5f;
+			float w0 = (cx - bx) * (fy - by) - (cy - by) * (fx - bx);
+			float w1 = (ax - cx) * (fy - cy) - (ay - cy) * (fx - cx);
+			float w2 = (bx - ax) * (fy - ay) - (by - ay) * (fx - ax);
+			float u, v, color[4];
+			unsigned char* stencil;
+
+			if (w0 < 0.0f || (w0 == 0.0f && !tl0)) continue;
+			if (w1 < 0.0f || (w1 == 0.0f && !tl1)) continue;
+			if (w2 < 0.0f || (w2 == 0.0f && !tl2)) continue;
+
+			w0 /= area;
+			w1 /= area;
+			w2 /= area;
+			u = a->u * w0 + b->u * w1 + c->u * w2;
+			v = a->v * w0 + b->v * w1 + c->v * w2;
+
+			if (!swnvg__shade(sw, ds, fx / sx, fy / sy, u, v, color)) continue;
+
+			stencil = &sw->stencil[py * sw->width + px];
+			if (!swnvg__stencilTest(ds->stencilFunc, *stencil)) continue;
+			swnvg__stencilApply(ds->stencilOp, stencil, front);
+
+			if (ds->colorWrite)
+				swnvg__blend(&ds->blend, &sw->pixels[(py * sw->width + px) * 4], color);
+		}
+	}
+}
+
+static void swnvg__drawFan(SWNVGcontext* sw, const SWNVGdrawState* ds, int offset, int count)
+{
+	int i;
+	for (i = 2; i < count; i++)
+		swnvg__rasterTriangle(sw, ds, &sw->verts[offset], &sw->verts[offset + i - 1], &sw->verts[offset + i]);
+}
+
+static void swnvg__drawStrip(SWNVGcontext* sw, const SWNVGdrawState* ds, int offset, int count)
+{
+	int i;
+	for (i = 2; i < count; i++) {
+		// Keep the winding consistent the way GL does for strips
+		if (i & 1)
+			swnvg__rasterTriangle(sw, ds, &sw->verts[offset + i - 1], &sw->verts[offset + i - 2], &sw->verts[offset + i]);
+		else
+			swnvg__rasterTriangle(sw, ds, &sw->verts[offset + i - 2], &sw->verts[offset + i - 1], &sw->verts[offset + i]);
+	}
+}
+
+static void swnvg__drawTriangles(SWNVGcontext* sw, const SWNVGdrawState* ds, int offset, int count)
+{
+	int i;
+	for (i = 0; i + 2 < count; i += 3)
+		swnvg__rasterTriangle(sw, ds, &sw->verts[offset + i], &sw->verts[offset + i + 1], &sw->verts[offset + i + 2]);
+}
+
+static void swnvg__setState(SWNVGcontext* sw, SWNVGdrawState* ds, SWNVGcall* call, int uniformOffset, int image,
+							int cull, int colorWrite, int stencilFunc, int stencilOp)
+{
+	ds->frag = &sw->uniforms[uniformOffset];
+	ds->tex = image != 0 ? swnvg__findTexture(sw, image) : NULL;
+	ds->blend = call->blendFunc;
+	ds->cull = cull;
+	ds->colorWrite = colorWrite;
+	ds->stencilFunc = stencilFunc;
+	ds->stencilOp = stencilOp;
+}
+
+static void swnvg__fill(SWNVGcontext* sw, SWNVGcall* call)
+{
+	SWNVGpath* paths = &sw->paths[call->pathOffset];
+	SWNVGdrawState ds;
+	int i, npaths = call->pathCount;
+
+	// Draw shapes into the stencil buffer, non-zero winding
+	swnvg__setState(sw, &ds, call, call->uniformOffset, 0, 0, 0, SWNVG_ALWAYS, SWNVG_INCR_WRAP_FRONT_DECR_WRAP_BACK);
+	for (i = 0; i < npaths; i++)
+		swnvg__drawFan(sw, &ds, paths[i].fillOffset, paths[i].fillCount);
+
+	// Draw anti-aliased pixels
+	if (sw->flags & NVGSW_ANTIALIAS) {
+		swnvg__setState(sw, &ds, call, call->uniformOffset + 1, call->image, 1, 1, SWNVG_EQUAL, SWNVG_KEEP);
+		for (i = 0; i < npaths; i++)
+			swnvg__drawStrip(sw, &ds, paths[i].strokeOffset, paths[i].strokeCount);
+	}
+
+	// Draw fill
+	swnvg__setState(sw, &ds, call, call->uniformOffset + 1, call->image, 1, 1, SWNVG_NOTEQUAL, SWNVG_ZERO);
+	swnvg__drawStrip(sw, &ds, call->triangleOffset, call->triangleCount);
+}
+
+static void swnvg__convexFill(SWNVGcontext* sw, SWNVGcall* call)
+{
+	SWNVGpath* paths = &sw->paths[call->pathOffset];
+	SWNVGdrawState ds;
+	int i, npaths = call->pathCount;
+
+	swnvg__setState(sw, &ds, call, call->uniformOffset, call->image, 1, 1, SWNVG_ALWAYS, SWNVG_KEEP);
+	for (i = 0; i < npaths; i++) {
+		swnvg__drawFan(sw, &ds, paths[i].fillOffset, paths[i].fillCount);
+		// Draw fringes
+		if (paths[i].strokeCount > 0)
+			swnvg__drawStrip(sw, &ds, paths[i].strokeOffset, paths[i].strokeCount);
+	}
+}
+
+static void swnvg__stroke(SWNVGcontext* sw, SWNVGcall* call)
+{
+	SWNVGpath* paths = &sw->paths[call->pathOffset];
+	SWNVGdrawState ds;
+	int npaths = call->pathCount, i;
+
+	if (sw->flags & NVGSW_STENCIL_STROKES) {
+		// Fill the stroke base without overlap
+		swnvg__setState(sw, &ds, call, call->uniformOffset + 1, call->image, 1, 1, SWNVG_EQUAL, SWNVG_INCR);
+		for (i = 0; i < npaths; i++)
+			swnvg__drawStrip(sw, &ds, paths[i].strokeOffset, paths[i].strokeCount);
+
+		// Draw anti-aliased pixels.
+		swnvg__setState(sw, &ds, call, call->uniformOffset, call->image, 1, 1, SWNVG_EQUAL, SWNVG_KEEP);
+		for (i = 0; i < npaths; i++)
+			swnvg__drawStrip(sw, &ds, paths[i].strokeOffset, paths[i].strokeCount);
+
+		// Clear stencil buffer.
+		swnvg__setState(sw, &ds, call, call->uniformOffset, call->image, 1, 0, SWNVG_ALWAYS, SWNVG_ZERO);
+		for (i = 0; i < npaths; i++)
+			swnvg__drawStrip(sw, &ds, paths[i].strokeOffset, paths[i].strokeCount);
+	} else {
+		// Draw Strokes
+		swnvg__setState(sw, &ds, call, call->uniformOffset, call->image, 1, 1, SWNVG_ALWAYS, SWNVG_KEEP);
+		for (i = 0; i < npaths; i++)
+			swnvg__drawStrip(sw, &ds, paths[i].strokeOffset, paths[i].strokeCount);
+	}
+}
+
+static void swnvg__triangles(SWNVGcontext* sw, SWNVGcall* call)
+{
+	SWNVGdrawState ds;
+	swnvg__setState(sw, &ds, call, call->uniformOffset, call->image, 1, 1, SWNVG_ALWAYS, SWNVG_KEEP);
+	swnvg__drawTriangles(sw, &ds, call->triangleOffset, call->triangleCount);
+}
+
+static void swnvg__renderCancel(void* uptr) {
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	sw->nverts = 0;
+	sw->npaths = 0;
+	sw->ncalls = 0;
+	sw->nuniforms = 0;
+}
+
+static void swnvg__renderFlush(void* uptr)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	int i;
+
+	if (sw->ncalls > 0 && sw->pixels != NULL && sw->view[0] > 0.0f && sw->view[1] > 0.0f) {
+		sw->stats.calls += sw->ncalls;
+		sw->stats.vertices += sw->nverts;
+		sw->stats.uniformBytes += sw->nuniforms * (int)sizeof(SWNVGfragUniforms);
+
+		for (i = 0; i < sw->ncalls; i++) {
+			SWNVGcall* call = &sw->calls[i];
+			if (call->type == SWNVG_FILL)
+				sw->stats.stencilFills++;
+			else if (call->type == SWNVG_CONVEXFILL)
+				sw->stats.convexFills++;
+			if (call->type == SWNVG_FILL)
+				swnvg__fill(sw, call);
+			else if (call->type == SWNVG_CONVEXFILL)
+				swnvg__convexFill(sw, call);
+			else if (call->type == SWNVG_STROKE)
+				swnvg__stroke(sw, call);
+			else if (call->type == SWNVG_TRIANGLES)
+				swnvg__triangles(sw, call);
+		}
+	}
+
+	// Reset calls
+	sw->nverts = 0;
+	sw->npaths = 0;
+	sw->ncalls = 0;
+	sw->nuniforms = 0;
+}
+
+static int swnvg__maxVertCount(const NVGpath* paths, int npaths)
+{
+	int i, count = 0;
+	for (i = 0; i < npaths; i++) {
+		count += paths[i].nfill;
+		count += paths[i].nstroke;
+	}
+	return count;
+}
+
+static SWNVGcall* swnvg__allocCall(SWNVGcontext* sw)
+{
+	SWNVGcall* ret = NULL;
+	if (sw->ncalls+1 > sw->ccalls) {
+		SWNVGcall* calls;
+		int ccalls = swnvg__maxi(sw->ncalls+1, 128) + sw->ccalls/2; // 1.5x Overallocate
+		calls = (SWNVGcall*)realloc(sw->calls, sizeof(SWNVGcall) * ccalls);
+		if (calls == NULL) return NULL;
+		sw->calls = calls;
+		sw->ccalls = ccalls;
+	}
+	ret = &sw->calls[sw->ncalls++];
+	memset(ret, 0, sizeof(SWNVGcall));
+	return ret;
+}
+
+static int swnvg__allocPaths(SWNVGcontext* sw, int n)
+{
+	int ret = 0;
+	if (sw->npaths+n > sw->cpaths) {
+		SWNVGpath* paths;
+		int cpaths = swnvg__maxi(sw->npaths + n, 128) + sw->cpaths/2; // 1.5x Overallocate
+		paths = (SWNVGpath*)realloc(sw->paths, sizeof(SWNVGpath) * cpaths);
+		if (paths == NULL) return -1;
+		sw->paths = paths;
+		sw->cpaths = cpaths;
+	}
+	ret = sw->npaths;
+	sw->npaths += n;
+	return ret;
+}
+
+static int swnvg__allocVerts(SWNVGcontext* sw, int n)
+{
+	int ret = 0;
+	if (sw->nverts+n > sw->cverts) {
+		NVGvertex* verts;
+		int cverts = swnvg__maxi(sw->nverts + n, 4096) + sw->cverts/2; // 1.5x Overallocate
+		verts = (NVGvertex*)realloc(sw->verts, sizeof(NVGvertex) * cverts);
+		if (verts == NULL) return -1;
+		sw->verts = verts;
+		sw->cverts = cverts;
+	}
+	ret = sw->nverts;
+	sw->nverts += n;
+	return ret;
+}
+
+static int swnvg__allocFragUniforms(SWNVGcontext* sw, int n)
+{
+	int ret = 0;
+	if (sw->nuniforms+n > sw->cuniforms) {
+		SWNVGfragUniforms* uniforms;
+		int cuniforms = swnvg__maxi(sw->nuniforms+n, 128) + sw->cuniforms/2; // 1.5x Overallocate
+		uniforms = (SWNVGfragUniforms*)realloc(sw->uniforms, sizeof(SWNVGfragUniforms) * cuniforms);
+		if (uniforms == NULL) return -1;
+		sw->uniforms = uniforms;
+		sw->cuniforms = cuniforms;
+	}
+	ret = sw->nuniforms;
+	sw->nuniforms += n;
+	return ret;
+}
+
+static void swnvg__vset(NVGvertex* vtx, float x, float y, float u, float v)
+{
+	vtx->x = x;
+	vtx->y = y;
+	vtx->u = u;
+	vtx->v = v;
+}
+
+static void swnvg__renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+							  const float* bounds, const NVGpath* paths, int npaths)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGcall* call = swnvg__allocCall(sw);
+	NVGvertex* quad;
+	SWNVGfragUniforms* frag;
+	int i, maxverts, offset;
+
+	if (call == NULL) return;
+
+	call->type = SWNVG_FILL;
+	call->triangleCount = 4;
+	call->pathOffset = swnvg__allocPaths(sw, npaths);
+	if (call->pathOffset == -1) goto error;
+	call->pathCount = npaths;
+	call->image = paint->image;
+	call->blendFunc = swnvg__blendCompositeOperation(compositeOperation);
+
+	if (npaths == 1 && paths[0].convex)
+	{
+		call->type = SWNVG_CONVEXFILL;
+		call->triangleCount = 0;	// Bounding box fill quad not needed for convex fill
+	}
+
+	// Allocate vertices for all the paths.
+	maxverts = swnvg__maxVertCount(paths, npaths) + call->triangleCount;
+	offset = swnvg__allocVerts(sw, maxverts);
+	if (offset == -1) goto error;
+
+	for (i = 0; i < npaths; i++) {
+		SWNVGpath* copy = &sw->paths[call->pathOffset + i];
+		const NVGpath* path = &paths[i];
+		memset(copy, 0, sizeof(SWNVGpath));
+		if (path->nfill > 0) {
+			copy->fillOffset = offset;
+			copy->fillCount = path->nfill;
+			memcpy(&sw->verts[offset], path->fill, sizeof(NVGvertex) * path->nfill);
+			offset += path->nfill;
+		}
+		if (path->nstroke > 0) {
+			copy->strokeOffset = offset;
+			copy->strokeCount = path->nstroke;
+			memcpy(&sw->verts[offset], path->stroke, sizeof(NVGvertex) * path->nstroke);
+			offset += path->nstroke;
+		}
+	}
+
+	// Setup uniforms for draw calls
+	if (call->type == SWNVG_FILL) {
+		// Quad
+		call->triangleOffset = offset;
+		quad = &sw->verts[call->triangleOffset];
+		swnvg__vset(&quad[0], bounds[2], bounds[3], 0.5f, 1.0f);
+		swnvg__vset(&quad[1], bounds[2], bounds[1], 0.5f, 1.0f);
+		swnvg__vset(&quad[2], bounds[0], bounds[3], 0.5f, 1.0f);
+		swnvg__vset(&quad[3], bounds[0], bounds[1], 0.5f, 1.0f);
+
+		call->uniformOffset = swnvg__allocFragUniforms(sw, 2);
+		if (call->uniformOffset == -1) goto error;
+		// Simple shader for stencil
+		frag = &sw->uniforms[call->uniformOffset];
+		memset(frag, 0, sizeof(*frag));
+		frag->strokeThr = -1.0f;
+		frag->type = SWNVG_SHADER_SIMPLE;
+		// Fill shader
+		swnvg__convertPaint(sw, &sw->uniforms[call->uniformOffset + 1], paint, scissor, fringe, fringe, -1.0f);
+	} else {
+		call->uniformOffset = swnvg__allocFragUniforms(sw, 1);
+		if (call->uniformOffset == -1) goto error;
+		// Fill shader
+		swnvg__convertPaint(sw, &sw->uniforms[call->uniformOffset], paint, scissor, fringe, fringe, -1.0f);
+	}
+
+	return;
+
+error:
+	// We get here if call alloc was ok, but something else is not.
+	// Roll back the last call to prevent drawing it.
+	if (sw->ncalls > 0) sw->ncalls--;
+}
+
+static void swnvg__renderStroke(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+								float strokeWidth, const NVGpath* paths, int npaths)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGcall* call = swnvg__allocCall(sw);
+	int i, maxverts, offset;
+
+	if (call == NULL) return;
+
+	call->type = SWNVG_STROKE;
+	call->pathOffset = swnvg__allocPaths(sw, npaths);
+	if (call->pathOffset == -1) goto error;
+	call->pathCount = npaths;
+	call->image = paint->image;
+	call->blendFunc = swnvg__blendCompositeOperation(compositeOperation);
+
+	// Allocate vertices for all the paths.
+	maxverts = swnvg__maxVertCount(paths, npaths);
+	offset = swnvg__allocVerts(sw, maxverts);
+	if (offset == -1) goto error;
+
+	for (i = 0; i < npaths; i++) {
+		SWNVGpath* copy = &sw->paths[call->pathOffset + i];
+		const NVGpath* path = &paths[i];
+		memset(copy, 0, sizeof(SWNVGpath));
+		if (path->nstroke) {
+			copy->strokeOffset = offset;
+			copy->strokeCount = path->nstroke;
+			memcpy(&sw->verts[offset], path->stroke, sizeof(NVGvertex) * path->nstroke);
+			offset += path->nstroke;
+		}
+	}
+
+	if (sw->flags & NVGSW_STENCIL_STROKES) {
+		// Fill shader
+		call->uniformOffset = swnvg__allocFragUniforms(sw, 2);
+		if (call->uniformOffset == -1) goto error;
+
+		swnvg__convertPaint(sw, &sw->uniforms[call->uniformOffset], paint, scissor, strokeWidth, fringe, -1.0f);
+		swnvg__convertPaint(sw, &sw->uniforms[call->uniformOffset + 1], paint, scissor, strokeWidth, fringe, 1.0f - 0.5f/255.0f);
+
+	} else {
+		// Fill shader
+		call->uniformOffset = swnvg__allocFragUniforms(sw, 1);
+		if (call->uniformOffset == -1) goto error;
+		swnvg__convertPaint(sw, &sw->uniforms[call->uniformOffset], paint, scissor, strokeWidth, fringe, -1.0f);
+	}
+
+	return;
+
+error:
+	// We get here if call alloc was ok, but something else is not.
+	// Roll back the last call to prevent drawing it.
+	if (sw->ncalls > 0) sw->ncalls--;
+}
+
+static void swnvg__renderTriangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor,
+								   const NVGvertex* verts, int nverts, float fringe)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGcall* call = swnvg__allocCall(sw);
+	SWNVGfragUniforms* frag;
+
+	if (call == NULL) return;
+
+	call->type = SWNVG_TRIANGLES;
+	call->image = paint->image;
+	call->blendFunc = swnvg__blendCompositeOperation(compositeOperation);
+
+	// Allocate vertices for all the paths.
+	call->triangleOffset = swnvg__allocVerts(sw, nverts);
+	if (call->triangleOffset == -1) goto error;
+	call->triangleCount = nverts;
+
+	memcpy(&sw->verts[call->triangleOffset], verts, sizeof(NVGvertex) * nverts);
+
+	// Fill shader
+	call->uniformOffset = swnvg__allocFragUniforms(sw, 1);
+	if (call->uniformOffset == -1) goto error;
+	frag = &sw->uniforms[call->uniformOffset];
+	swnvg__convertPaint(sw, frag, paint, scissor, 1.0f, fringe, -1.0f);
+	frag->type = SWNVG_SHADER_IMG;
+
+	return;
+
+error:
+	// We get here if call alloc was ok, but something else is not.
+	// Roll back the last call to prevent drawing it.
+	if (sw->ncalls > 0) sw->ncalls--;
+}
+
+static void swnvg__renderDelete(void* uptr)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	int i;
+	if (sw == NULL) return;
+
+	for (i = 0; i < sw->ntextures; i++)
+		free(sw->textures[i].data);
+	free(sw->textures);
+
+	free(sw->pixels);
+	free(sw->stencil);
+
+	free(sw->paths);
+	free(sw->verts);
+	free(sw->uniforms);
+	free(sw->calls);
+
+	free(sw);
+}
+
+NVGcontext* nvgCreateSW(int flags)
+{
+	NVGparams params;
+	NVGcontext* ctx = NULL;
+	SWNVGcontext* sw = (SWNVGcontext*)malloc(sizeof(SWNVGcontext));
+	if (sw == NULL) goto error;
+	memset(sw, 0, sizeof(SWNVGcontext));
+
+	memset(&params, 0, sizeof(params));
+	params.renderCreate = swnvg__renderCreate;
+	params.renderCreateTexture = swnvg__renderCreateTexture;
+	params.renderDeleteTexture = swnvg__renderDeleteTexture;
+	params.renderUpdateTexture = swnvg__renderUpdateTexture;
+	params.renderGetTextureSize = swnvg__renderGetTextureSize;
+	params.renderViewport = swnvg__renderViewport;
+	params.renderCancel = swnvg__renderCancel;
+	params.renderFlush = swnvg__renderFlush;
+	params.renderFill = swnvg__renderFill;
+	params.renderStroke = swnvg__renderStroke;
+	params.renderTriangles = swnvg__renderTriangles;
+	params.renderDelete = swnvg__renderDelete;
+	params.userPtr = sw;
+	params.edgeAntiAlias = flags & NVGSW_ANTIALIAS ? 1 : 0;
+	params.renderStats = &sw->stats;
+
+	sw->flags = flags;
+
+	ctx = nvgCreateInternal(&params);
+	if (ctx == NULL) goto error;
+
+	return ctx;
+
+error:
+	// 'sw' is freed by nvgDeleteInternal.
+	if (ctx != NULL) nvgDeleteInternal(ctx);
+	return NULL;
+}
+
+void nvgDeleteSW(NVGcontext* ctx)
+{
+	nvgDeleteInternal(ctx);
+}
+
+void nvgswClear(NVGcontext* ctx, int width, int height, NVGcolor color)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	unsigned char rgba[4];
+	int i;
+
+	if (width != sw->width || height != sw->height || sw->pixels == NULL) {
+		free(sw->pixels);
+		free(sw->stencil);
+		sw->pixels = (unsigned char*)malloc(width * height * 4);
+		sw->stencil = (unsigned char*)malloc(width * height);
+		if (sw->pixels == NULL || sw->stencil == NULL) {
+			free(sw->pixels);
+			free(sw->stencil);
+			sw->pixels = NULL;
+			sw->stencil = NULL;
+			sw->width = sw->height = 0;
+			return;
+		}
+		sw->width = width;
+		sw->height = height;
+	}
+
+	rgba[0] = swnvg__toByte(color.r);
+	rgba[1] = swnvg__toByte(color.g);
+	rgba[2] = swnvg__toByte(color.b);
+	rgba[3] = swnvg__toByte(color.a);
+	for (i = 0; i < width * height; i++)
+		memcpy(&sw->pixels[i * 4], rgba, 4);
+	memset(sw->stencil, 0, width * height);
+}
+
+void nvgswClearRect(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	unsigned char rgba[4];
+	int x0 = swnvg__maxi(x, 0), y0 = swnvg__maxi(y, 0);
+	int x1 = swnvg__mini(x + w, sw->width), y1 = swnvg__mini(y + h, sw->height);
+	int i, j;
+
+	if (sw->pixels == NULL) return;
+
+	rgba[0] = swnvg__toByte(color.r);
+	rgba[1] = swnvg__toByte(color.g);
+	rgba[2] = swnvg__toByte(color.b);
+	rgba[3] = swnvg__toByte(color.a);
+	for (j = y0; j < y1; j++) {
+		for (i = x0; i < x1; i++)
+			memcpy(&sw->pixels[(j * sw->width + i) * 4], rgba, 4);
+		memset(&sw->stencil[j * sw->width + x0], 0, x1 - x0 > 0 ? x1 - x0 : 0);
+	}
+}
+
+const unsigned char* nvgswFramebuffer(NVGcontext* ctx, int* width, int* height)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	*width = sw->width;
+	*height = sw->height;
+	return sw->pixels;
+}
+
+#endif /* NANOVG_SW_IMPLEMENTATION */
@@ -7,32 +7,72 @@
 //
 
 #include "core.hpp"
+#include "animation.hpp"
 #include <chrono>
 #include <vector>
+#include <stdint.h>
 
+// Active animations are kept densely in a vector, which is what the
+// per-frame passes walk over, and are found by identifier through an
+// open-addressing hash table (linear probing) that holds their index in
+// that vector. Animations are removed by moving the last one into their
+// place, so the table only needs one entry patched up.
 struct ActiveAnimation {
     const void* identifier;
     std::chrono::high_resolution_clock::time_point start_time;
+    std::chrono::high_resolution_clock::duration update_interval;
     bool touched;
+
+    // Tweens
+    bool is_tween;
+    bool finished;
+    double from, to, duration, value;
+    double (*easing)(double);
 };
 
+static const int EMPTY_SLOT = -1;
+
 static std::chrono::high_resolution_clock::time_point last_update_time;
 static std::vector<ActiveAnimation> active_animations;
+static std::vector<int> table;
+static int table_shift = 64;
+static int num_running_animations;
 
 static int find_active_animation(const void* identifier);
+static int add_active_animation(const ActiveAnimation& animation);
+static void remove_active_animation(int index);
+static void evaluate_tweens();
 
 void ddui::animation::start(const void* identifier) {
+    start(identifier, 0.0);
+}
+
+void ddui::animation::start(const void* identifier, double update_interval) {
+    record_animation_use(identifier);
 
     ActiveAnimation new_animation;
     new_animation.identifier = identifier;
     new_animation.start_time = std::chrono::high_resolution_clock::now();
+    new_animation.update_interval = std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+        std::chrono::duration<double>(update_interval > 0.0 ? update_interval : 0.0)
+    );
     new_animation.touched = true;
+    new_animation.is_tween = false;
+    new_animation.finished = false;
+    new_animation.from = 0.0;
+    new_animation.to = 0.0;
+    new_animation.duration = 0.0;
+    new_animation.value = 0.0;
+    new_animation.easing = NULL;
 
     int i = find_active_animation(identifier);
     if (i != -1) {
+        if (active_animations[i].finished) {
+            num_running_animations += 1;
+        }
         active_animations[i] = new_animation;
     } else {
-        active_animations.push_back(new_animation);
+        add_active_animation(new_animation);
     }
 }
 
@@ -40,11 +80,12 @@ void ddui::animation::stop(const void* identifier) {
 
     int i = find_active_animation(identifier);
     if (i != -1) {
-        active_animations.erase(active_animations.begin() + i);
+        remove_active_animation(i);
     }
 }
 
 bool ddui::animation::is_animating(const void* identifier) {
+    record_animation_use(identifier);
 
     int i = find_active_animation(identifier);
     if (i == -1) {
@@ -52,10 +93,11 @@ bool ddui::animation::is_animating(const void* identifier) {
     }
 
     active_animations[i].touched = true;
-    return true;
+    return !active_animations[i].finished;
 }
 
 double ddui::animation::get_time_elapsed(const void* identifier) {
+    record_animation_use(identifier);
 
     int i = find_active_animation(identifier);
     if (i == -1) {
@@ -72,6 +114,64 @@ double ddui::animation::get_time_elapsed(const void* identifier) {
     return time_elapsed;
 }
 
+double ddui::animation::tween(const void* identifier, double from, double to, double duration, double (*easing)(double)) {
+    record_animation_use(identifier);
+
+    int i = find_active_animation(identifier);
+    if (i == -1) {
+        ActiveAnimation new_animation;
+        new_animation.identifier = identifier;
+        new_animation.start_time = last_update_time;
+        new_animation.update_interval = std::chrono::high_resolution_clock::duration::zero();
+        new_animation.touched = true;
+        new_animation.is_tween = true;
+        new_animation.finished = false;
+        new_animation.from = from;
+        new_animation.to = to;
+        new_animation.duration = duration;
+        new_animation.value = from;
+        new_animation.easing = easing;
+        add_active_animation(new_animation);
+        return from;
+    }
+
+    auto& animation = active_animations[i];
+    animation.touched = true;
+
+    // The identifier belongs to an animation made by start(), which
+    // becomes this tween, starting over from the beginning
+    if (!animation.is_tween) {
+        if (animation.finished) {
+            num_running_animations += 1;
+        }
+        animation.start_time = last_update_time;
+        animation.update_interval = std::chrono::high_resolution_clock::duration::zero();
+        animation.is_tween = true;
+        animation.finished = false;
+        animation.from = from;
+        animation.to = to;
+        animation.duration = duration;
+        animation.value = from;
+        animation.easing = easing;
+        return from;
+    }
+
+    // A new target: carry on from wherever we are now
+    if (animation.to != to) {
+        if (animation.finished) {
+            num_running_animations += 1;
+        }
+        animation.start_time = last_update_time;
+        animation.finished = false;
+        animation.from = animation.value;
+        animation.to = to;
+        animation.duration = duration;
+        animation.easing = easing;
+    }
+
+    return animation.value;
+}
+
 double ddui::animation::ease_in(double completion) {
     return completion * completion;
 }
@@ -89,26 +189,171 @@ double ddui::animation::ease_in_out(double completion) {
 }
 
 bool ddui::animation::is_animating() {
-    return !active_animations.empty();
+    return num_running_animations > 0;
 }
 
-int find_active_animation(const void* identifier) {
+static int hash_slot(const void* identifier) {
+    // Fibonacci hashing, the top bits of the product are the best mixed
+    return (int)(((uint64_t)(uintptr_t)identifier * 0x9E3779B97F4A7C15ull) >> table_shift);
+}
+
+static void rebuild_table(int capacity) {
+    table.assign(capacity, EMPTY_SLOT);
+    table_shift = 64;
+    while ((1 << (64 - table_shift)) < capacity) {
+        table_shift -= 1;
+    }
+
+    auto mask = capacity - 1;
     for (int i = 0; i < active_animations.size(); ++i) {
-        if (active_animations[i].identifier == identifier) {
-            return i;
+        auto slot = hash_slot(active_animations[i].identifier);
+        while (table[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = i;
+    }
+}
+
+static int find_slot(const void* identifier) {
+    if (table.empty()) {
+        return -1;
+    }
+    auto mask = (int)table.size() - 1;
+    auto slot = hash_slot(identifier);
+    while (table[slot] != EMPTY_SLOT) {
+        if (active_animations[table[slot]].identifier == identifier) {
+            return slot;
         }
+        slot = (slot + 1) & mask;
     }
     return -1;
 }
 
+int find_active_animation(const void* identifier) {
+    auto slot = find_slot(identifier);
+    return slot == -1 ? -1 : table[slot];
+}
+
+int add_active_animation(const ActiveAnimation& animation) {
+    int index = (int)active_animations.size();
+    active_animations.push_back(animation);
+    if (!animation.finished) {
+        num_running_animations += 1;
+    }
+
+    // Keep the table at most half full
+    if (active_animations.size() * 2 > table.size()) {
+        rebuild_table(table.empty() ? 16 : (int)table.size() * 2);
+        return index;
+    }
+
+    auto mask = (int)table.size() - 1;
+    auto slot = hash_slot(animation.identifier);
+    while (table[slot] != EMPTY_SLOT) {
+        slot = (slot + 1) & mask;
+    }
+    table[slot] = index;
+    return index;
+}
+
+void remove_active_animation(int index) {
+    if (!active_animations[index].finished) {
+        num_running_animations -= 1;
+    }
+
+    // Take the entry out of the table, shifting back the entries
+    // after it that would otherwise no longer be found
+    auto mask = (int)table.size() - 1;
+    auto slot = find_slot(active_animations[index].identifier);
+    auto next = (slot + 1) & mask;
+    while (table[next] != EMPTY_SLOT) {
+        auto home = hash_slot(active_animations[table[next]].identifier);
+        auto distance_from_home = (next - home) & mask;
+        auto distance_to_hole = (next - slot) & mask;
+        if (distance_from_home >= distance_to_hole) {
+            table[slot] = table[next];
+            slot = next;
+        }
+        next = (next + 1) & mask;
+    }
+    table[slot] = EMPTY_SLOT;
+
+    // Move the last animation into the gap
+    auto last = (int)active_animations.size() - 1;
+    if (index != last) {
+        table[find_slot(active_animations[last].identifier)] = index;
+        active_animations[index] = active_animations[last];
+    }
+    active_animations.pop_back();
+}
+
+void evaluate_tweens() {
+    for (auto& animation : active_animations) {
+        if (!animation.is_tween || animation.finished) {
+            continue;
+        }
+
+        auto time_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+            last_update_time - animation.start_time
+        ).count();
+        auto completion = animation.duration > 0.0 ? time_elapsed / animation.duration : 1.0;
+        if (completion >= 1.0) {
+            animation.value = animation.to;
+            animation.finished = true;
+            num_running_animations -= 1;
+            continue;
+        }
+
+        auto eased = animation.easing ? animation.easing(completion) : completion;
+        animation.value = animation.from + (animation.to - animation.from) * eased;
+    }
+}
+
+bool ddui::is_animation_running(const void* identifier) {
+    int i = find_active_animation(identifier);
+    return i != -1 && !active_animations[i].finished;
+}
+
+void ddui::touch_animation(const void* identifier) {
+    int i = find_active_animation(identifier);
+    if (i != -1) {
+        active_animations[i].touched = true;
+    }
+}
+
+double get_animation_wait_time() {
+    // Each animation wants a frame on every multiple of its update interval
+    // since it started. Animations without an interval want every frame.
+    auto current_time = std::chrono::high_resolution_clock::now();
+    auto wait_time = std::chrono::high_resolution_clock::duration::max();
+    for (auto& active_animation : active_animations) {
+        if (active_animation.finished) {
+            continue;
+        }
+        auto interval = active_animation.update_interval;
+        if (interval.count() <= 0) {
+            return 0.0;
+        }
+        auto elapsed = current_time - active_animation.start_time;
+        auto time_to_update = interval - elapsed % interval;
+        if (wait_time > time_to_update) {
+            wait_time = time_to_update;
+        }
+    }
+    if (num_running_animations == 0) {
+        return 0.0;
+    }
+    return std::chrono::duration_cast<std::chrono::duration<double>>(wait_time).count();
+}
+
 void update_animation() {
     // Update the current time
     last_update_time = std::chrono::high_resolution_clock::now();
 
     // Remove inactive animations
-    for (int i = active_animations.size() - 1; i >= 0; --i) {
+    for (int i = (int)active_animations.size() - 1; i >= 0; --i) {
         if (!active_animations[i].touched) {
-            active_animations.erase(active_animations.begin() + i);
+            remove_active_animation(i);
         }
     }
 
@@ -116,4 +361,7 @@ void update_animation() {
     for (auto& active_animation : active_animations) {
         active_animation.touched = false;
     }
+
+    // Work out the values of all tweens for this frame
+    evaluate_tweens();
 }
@@ -11,4 +11,18 @@
 
 void update_animation();
 
+// Seconds until the next running animation wants a frame, or 0 if
+// one of them wants every frame
+double get_animation_wait_time();
+
+// For cached views, which have to know the animations they draw. The
+// animation functions report the identifiers they're given to
+// record_animation_use() (in core.cpp), and a replayed view touches them
+// to keep them alive the way calling them would.
+namespace ddui {
+    void record_animation_use(const void* identifier);
+    bool is_animation_running(const void* identifier);
+    void touch_animation(const void* identifier);
+}
+
 #endif
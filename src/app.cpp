@@ -9,9 +9,34 @@
 #include "app.hpp"
 #include "core.hpp"
 #include "glfw.hpp"
+#include "animation.hpp"
+#ifdef __linux__
+#include "event_loop.hpp"
+#endif
+#include <math.h>
 
 namespace ddui {
 
+// input.cpp internal functions
+bool has_input_events_to_process();
+
+// Frame scheduling
+//
+// While something is animating, frames are paced to the refresh rate of the
+// monitor the window is on, or to the frame-rate cap if that is lower, or to
+// the earliest animation deadline when animations ask for fewer frames. In
+// between frames we wait on the event queue, so input still gets a frame
+// straight away. Any other wake-up (a timer callback being queued, a repaint
+// from another thread, the mouse moving) is held back to the next refresh
+// instead of getting a frame of its own.
+static const double DEFAULT_REFRESH_RATE = 60.0;
+static double max_frame_rate = 0.0;
+static bool uses_event_loop = false;
+static void wait_events(double timeout);
+static double get_refresh_rate(GLFWwindow* window);
+static double next_refresh_time(double anchor, double refresh_interval, double time);
+static void wait_for_frame(GLFWwindow* window, double frame_time, double deadline, double refresh_interval);
+
 bool app_init(int window_width, int window_height, const char* title, std::function<void()> update_proc) {
     auto ddui_state = get_state();
     if (!ddui::init_glfw()) {
@@ -26,25 +51,141 @@ bool app_init(int window_width, int window_height, const char* title, std::funct
     }
 
     ddui::init_window(ddui_state->glfw_window, update_proc);
+
+#ifdef __linux__
+    // Before ddui::init() starts the threads that post to the UI thread
+    uses_event_loop = event_loop_init(ddui_state->glfw_window);
+#endif
+
     if (!ddui::init()) {
         printf("Could not init ddui.\n");
         return false;
     }
 
+#ifdef __linux__
+    if (uses_event_loop) {
+        event_loop_take_over_timers();
+    }
+#endif
+
     return true;
 }
 
+void app_set_max_frame_rate(double frames_per_second) {
+    max_frame_rate = frames_per_second > 0.0 ? frames_per_second : 0.0;
+}
+
 void app_run() {
     auto ddui_state = get_state();
+    auto window = ddui_state->glfw_window;
+
+    while (!glfwWindowShouldClose(window)) {
+        auto frame_time = glfwGetTime();
+        ddui::update_window(window);
 
-    while (!glfwWindowShouldClose(ddui_state->glfw_window)) {
-        ddui::update_window(ddui_state->glfw_window);
-        if (ddui::animation::is_animating()) {
-            glfwWaitEventsTimeout(15e-3);
-        } else {
-            glfwWaitEvents();
+        if (!ddui::animation::is_animating()) {
+            wait_events(-1.0);
+            continue;
         }
+
+        auto refresh_interval = 1.0 / get_refresh_rate(window);
+        auto frame_interval = refresh_interval;
+        if (max_frame_rate > 0.0 && 1.0 / max_frame_rate > frame_interval) {
+            frame_interval = 1.0 / max_frame_rate;
+        }
+
+        // Animations with an update interval may want even fewer frames.
+        // Round their deadline to a refresh so the frame lines up with it.
+        auto animation_wait_time = get_animation_wait_time();
+        auto deadline = frame_time + frame_interval;
+        if (frame_time + animation_wait_time > deadline) {
+            deadline = next_refresh_time(frame_time, refresh_interval, glfwGetTime() + animation_wait_time);
+        }
+
+        wait_for_frame(window, frame_time, deadline, refresh_interval);
+    }
+}
+
+void wait_for_frame(GLFWwindow* window, double frame_time, double deadline, double refresh_interval) {
+    while (!glfwWindowShouldClose(window)) {
+        auto time = glfwGetTime();
+        if (time >= deadline) {
+            return;
+        }
+
+        wait_events(deadline - time);
+        if (has_input_events_to_process()) {
+            return;
+        }
+
+        // Woken up early by something other than input
+        time = glfwGetTime();
+        if (time < deadline) {
+            auto refresh_time = next_refresh_time(frame_time, refresh_interval, time);
+            if (deadline > refresh_time) {
+                deadline = refresh_time;
+            }
+        }
+    }
+}
+
+void wait_events(double timeout) {
+#ifdef __linux__
+    if (uses_event_loop) {
+        event_loop_wait(timeout);
+        return;
+    }
+#endif
+    if (timeout < 0.0) {
+        glfwWaitEvents();
+    } else {
+        glfwWaitEventsTimeout(timeout);
+    }
+}
+
+double next_refresh_time(double anchor, double refresh_interval, double time) {
+    // Allow a little slack so a time right on a refresh isn't pushed out by rounding
+    auto refreshes = ceil((time - anchor) / refresh_interval - 1e-3);
+    return anchor + refreshes * refresh_interval;
+}
+
+double get_refresh_rate(GLFWwindow* window) {
+    auto monitor = glfwGetWindowMonitor(window);
+
+    // Windowed mode: use the monitor that holds the centre of the window
+    if (!monitor) {
+        int x, y, width, height;
+        glfwGetWindowPos(window, &x, &y);
+        glfwGetWindowSize(window, &width, &height);
+        auto centre_x = x + width / 2;
+        auto centre_y = y + height / 2;
+
+        int count;
+        auto monitors = glfwGetMonitors(&count);
+        for (int i = 0; i < count; ++i) {
+            auto mode = glfwGetVideoMode(monitors[i]);
+            if (!mode) {
+                continue;
+            }
+            int monitor_x, monitor_y;
+            glfwGetMonitorPos(monitors[i], &monitor_x, &monitor_y);
+            if (centre_x >= monitor_x && centre_x < monitor_x + mode->width &&
+                centre_y >= monitor_y && centre_y < monitor_y + mode->height) {
+                monitor = monitors[i];
+                break;
+            }
+        }
+    }
+
+    if (!monitor) {
+        monitor = glfwGetPrimaryMonitor();
+    }
+
+    auto mode = monitor ? glfwGetVideoMode(monitor) : NULL;
+    if (!mode || mode->refreshRate <= 0) {
+        return DEFAULT_REFRESH_RATE;
     }
+    return (double)mode->refreshRate;
 }
 
 }
@@ -16,6 +16,24 @@ namespace ddui {
 bool app_init(int window_width, int window_height, const char* title, std::function<void()> update_proc);
 void app_run();
 
+// Caps the rate at which app_run() draws frames while something is
+// animating. By default frames follow the refresh rate of the monitor
+// the window is on. Pass 0 to remove the cap.
+void app_set_max_frame_rate(double frames_per_second);
+
+#ifdef __linux__
+// Calls the callback on the UI thread, from app_run(), whenever the fd is
+// ready for any of the given events. Watching an fd again replaces its
+// events and callback. Must be called from the UI thread, and is only
+// serviced when app_run() uses the epoll event loop (i.e. on X11).
+enum {
+    APP_FD_READABLE = 1 << 0,
+    APP_FD_WRITABLE = 1 << 1
+};
+void app_watch_fd(int fd, int events, std::function<void(int events)> callback);
+void app_unwatch_fd(int fd);
+#endif
+
 }
 
 #endif
@@ -0,0 +1,144 @@
+//
+//  callback_queue.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "callback_queue.hpp"
+
+static const int RELEASE_BATCH_SIZE = 64;
+static std::atomic<CallbackNode*> free_nodes(nullptr);
+
+static void release_nodes(CallbackNode* first, CallbackNode* last) {
+    auto next = free_nodes.load(std::memory_order_relaxed);
+    do {
+        last->next.store(next, std::memory_order_relaxed);
+    } while (!free_nodes.compare_exchange_weak(next, first,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+// Nodes taken off the free list by this thread. The nodes go back
+// onto the free list when the thread exits.
+struct NodeCache {
+    CallbackNode* nodes = nullptr;
+
+    ~NodeCache() {
+        if (!nodes) {
+            return;
+        }
+        auto last = nodes;
+        while (auto next = last->next.load(std::memory_order_relaxed)) {
+            last = next;
+        }
+        release_nodes(nodes, last);
+    }
+};
+
+static thread_local NodeCache node_cache;
+
+static CallbackNode* acquire_node() {
+    if (!node_cache.nodes) {
+        node_cache.nodes = free_nodes.exchange(nullptr, std::memory_order_acquire);
+    }
+    auto node = node_cache.nodes;
+    if (!node) {
+        return new CallbackNode();
+    }
+    node_cache.nodes = node->next.load(std::memory_order_relaxed);
+    return node;
+}
+
+CallbackQueue::CallbackQueue() {
+    stub.next.store(nullptr, std::memory_order_relaxed);
+    head.store(&stub, std::memory_order_relaxed);
+    tail = &stub;
+    released_first = nullptr;
+    released_last = nullptr;
+    num_released = 0;
+}
+
+CallbackQueue::~CallbackQueue() {
+    std::function<void()> callback;
+    while (pop(&callback)) {
+    }
+    flush_released_nodes();
+}
+
+void CallbackQueue::push(std::function<void()> callback) {
+    auto node = acquire_node();
+    node->callback = std::move(callback);
+    push_node(node);
+}
+
+void CallbackQueue::push_node(CallbackNode* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    auto prev = head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+bool CallbackQueue::pop(std::function<void()>* callback) {
+    auto node = tail;
+    auto next = node->next.load(std::memory_order_acquire);
+
+    // Step over the stub
+    if (node == &stub) {
+        if (!next) {
+            flush_released_nodes();
+            return false;
+        }
+        tail = next;
+        node = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (!next) {
+        // The node is the last one, or a producer has swapped the head
+        // but not yet linked its node in. In the latter case we come
+        // back to it on a later pop.
+        if (node != head.load(std::memory_order_acquire)) {
+            flush_released_nodes();
+            return false;
+        }
+
+        // Put the stub behind the last node, so it can be taken
+        push_node(&stub);
+        next = node->next.load(std::memory_order_acquire);
+        if (!next) {
+            flush_released_nodes();
+            return false;
+        }
+    }
+
+    tail = next;
+    *callback = std::move(node->callback);
+    node->callback = nullptr;
+    release_node(node);
+    return true;
+}
+
+void CallbackQueue::release_node(CallbackNode* node) {
+    node->next.store(released_first, std::memory_order_relaxed);
+    if (!released_first) {
+        released_last = node;
+    }
+    released_first = node;
+    if (++num_released == RELEASE_BATCH_SIZE) {
+        flush_released_nodes();
+    }
+}
+
+void CallbackQueue::flush_released_nodes() {
+    if (released_first) {
+        release_nodes(released_first, released_last);
+        released_first = nullptr;
+        released_last = nullptr;
+        num_released = 0;
+    }
+}
+
+bool CallbackQueue::empty() const {
+    return head.load(std::memory_order_acquire) == &stub;
+}
@@ -0,0 +1,60 @@
+//
+//  callback_queue.hpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#ifndef ddui_callback_queue_hpp
+#define ddui_callback_queue_hpp
+
+#include <atomic>
+#include <functional>
+
+// A queue of callbacks that any number of threads can push into without
+// taking a lock, and that a single thread pops from. It is an intrusive
+// linked list in the style of Dmitry Vyukov's MPSC queue: a push is one
+// atomic exchange plus one store.
+//
+// The nodes are pooled and shared between all queues, so that pushing
+// doesn't allocate once the pool has warmed up. Popped nodes go back onto
+// a lock-free free list in batches, and each pushing thread takes the
+// whole free list at once into a cache of its own, so no node is ever
+// popped off the free list on its own (which would be open to the ABA
+// problem).
+
+struct CallbackNode {
+    std::atomic<CallbackNode*> next;
+    std::function<void()> callback;
+};
+
+class CallbackQueue {
+public:
+    CallbackQueue();
+    ~CallbackQueue();
+
+    // Can be called from any thread
+    void push(std::function<void()> callback);
+
+    // Must only be called from the consuming thread. A push that is
+    // still in progress on another thread may not be seen yet.
+    bool pop(std::function<void()>* callback);
+    bool empty() const;
+
+private:
+    void push_node(CallbackNode* node);
+    void release_node(CallbackNode* node);
+    void flush_released_nodes();
+
+    std::atomic<CallbackNode*> head;
+    CallbackNode* tail;
+    CallbackNode stub;
+
+    // Popped nodes that are yet to go back onto the free list
+    CallbackNode* released_first;
+    CallbackNode* released_last;
+    int num_released;
+};
+
+#endif
@@ -12,9 +12,23 @@
 #include "animation.hpp"
 #include "util/get_asset_filename.hpp"
 #include "profiling.hpp"
+#include "render_recorder.hpp"
+#include "callback_queue.hpp"
+#include "repaint_reasons.hpp"
+#include "text_measurement_cache.hpp"
+#include "glyph_rasterizer.hpp"
+#include "glyph_atlas_cache.hpp"
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <math.h>
 #include <mutex>
+#include <atomic>
+#include <string.h>
 #include <GL3/gl3w.h>
+#if defined(DDUI_BACKEND_SOFTWARE)
+#include <nanovg_sw.h>
+#endif
 
 namespace ddui {
 
@@ -39,22 +53,51 @@ struct FocusState {
 // Globals
 static NVGcontext* vg;
 static FocusState focus_state;
-static std::mutex repaint_mutex;
-static bool is_painting, should_repaint;
-static std::mutex set_immediate_mutex;
-static std::vector<std::function<void()>> set_immediate_callbacks;
-static std::mutex set_post_update_mutex;
-static std::vector<std::function<void()>> set_post_update_callbacks;
+enum RepaintFlags {
+    IS_PAINTING = 1 << 0,
+    SHOULD_REPAINT = 1 << 1
+};
+static std::atomic<unsigned> repaint_flags;
+static thread_local bool is_paint_thread;
+static std::atomic<int> num_repaint_calls;
+static std::atomic<int> max_passes_per_frame(10);
+static FramePassStats pass_stats, last_pass_stats;
+static RenderStats render_stats;
+static FontAtlasStats font_atlas_stats;
+static std::atomic<bool> dirty_all(true);
+static std::mutex repaint_mutex; // guards the dirty rect
+static bool has_dirty_rect;
+static float dirty_rect[4];
+static std::atomic<int> num_region_repaint_calls;
+static CallbackQueue set_immediate_queue;
+static CallbackQueue set_post_update_queue;
+static std::vector<std::function<void()>> post_update_callbacks;
 static Cursor cursor_state_old, cursor_state_new;
 MouseState mouse_state;
 KeyState key_state;
 FileDropState file_drop_state;
 Viewport view;
 static std::vector<Viewport> saved_views;
+static int frame_buffer_width, frame_buffer_height;
+static float frame_width, frame_height, frame_pixel_ratio;
+static bool frame_dirty_all, frame_has_dirty_rect, frame_is_partial;
+static float frame_dirty_rect[4];
+static int frame_clear_rect[4];
+static std::vector<unsigned char> read_framebuffer_pixels;
+
+// The regions the mouse was tested against in the last frame. As long as
+// the mouse doesn't enter or leave any of them, moving it can't change the
+// outcome of the frame, unless something asked to track every mouse move.
+struct HoverRegion {
+    float bounds[4];
+};
+static std::vector<HoverRegion> hover_regions;
+static bool hover_tracks_mouse;
 
 // input.cpp internal functions
 void pop_input_events_into_global_state();
 bool has_input_events_to_process();
+bool has_only_mouse_position_events(int* x, int* y);
 
 DDUIState *get_state() {
     static ddui::DDUIState state = {};
@@ -64,7 +107,13 @@ DDUIState *get_state() {
 // Setup
 bool init() {
     auto ddui_state = get_state();
-#ifdef _WIN32
+#if defined(DDUI_BACKEND_NULL) || defined(DDUI_BACKEND_SOFTWARE)
+
+    vg = nvgCreate();
+
+    // Running headless there is no event loop to wake up
+    set_post_empty_message_proc([]() {});
+#elif defined(_WIN32)
 
     ddui_state->hwnd = glfwGetWin32Window(ddui_state->glfw_window);
 
@@ -115,7 +164,10 @@ bool init() {
     cursor_state_old = CURSOR_ARROW;
     cursor_state_new = CURSOR_ARROW;
 
+    render_recorder_init(vg);
+
     create_font("entypo", "Entypo.ttf");
+    glyph_atlas_cache_init();
     timer_init();
 
     return true;
@@ -144,23 +196,53 @@ void set_set_cursor_proc(std::function<void(Cursor)> proc) {
 
 // Teardown
 void terminate() {
+    glyph_rasterizer_terminate(vg);
+    glyph_atlas_cache_terminate();
     nvgDelete(vg);
 }
 
 // Frame management
 static void update_pre(float width, float height, float pixel_ratio);
 static void update_post();
+static void request_repaint(const char* reason);
+static void add_pass_reason(const char* reason);
+static void update_render_stats();
+
+static bool is_mouse_move_unseen(float width, float height, float pixel_ratio);
 
-void update(float width, float height, float pixel_ratio, std::function<void()> update_proc) {
+bool update(float width, float height, float pixel_ratio, std::function<void()> update_proc) {
     auto ddui_state = get_state();
+
+    // A frame for a mouse move that no view can see would
+    // come out the same as the last one, so don't draw it
+    if (is_mouse_move_unseen(width, height, pixel_ratio)) {
+        pop_input_events_into_global_state();
+        return false;
+    }
+
     #ifdef DDUI_PROFILING_ON
         profiling::frame_start();
     #endif
 
+    auto start_time = std::chrono::steady_clock::now();
+
     // Setup frame
-    auto frame_buffer_width  = (int)(width * pixel_ratio);
-    auto frame_buffer_height = (int)(height * pixel_ratio);
-#ifdef _WIN32
+    frame_buffer_width  = (int)(width * pixel_ratio);
+    frame_buffer_height = (int)(height * pixel_ratio);
+    auto keeps_contents = nvgBindPersistentFramebuffer(vg, frame_buffer_width, frame_buffer_height);
+    if (!keeps_contents ||
+        width != frame_width ||
+        height != frame_height ||
+        pixel_ratio != frame_pixel_ratio) {
+        dirty_all = true;
+    }
+    frame_width = width;
+    frame_height = height;
+    frame_dirty_all = false;
+    frame_has_dirty_rect = false;
+#if defined(DDUI_BACKEND_NULL) || defined(DDUI_BACKEND_SOFTWARE)
+    // Nothing to set up
+#elif defined(_WIN32)
     // Rasterizing stage
     D3D11_VIEWPORT viewport = {
         0.0f, 0.0f,
@@ -173,23 +255,41 @@ void update(float width, float height, float pixel_ratio, std::function<void()>
     ddui_state->device_ctx->ClearRenderTargetView(ddui_state->swapchain_rtv, color);
 #else
     glViewport(0, 0, frame_buffer_width, frame_buffer_height);
-    glClearColor(0.949f, 0.949f, 0.949f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 #endif
-    repaint_mutex.lock();
-    is_painting = true;
-    repaint_mutex.unlock();
+    is_paint_thread = true;
+    pass_stats.frame_number = last_pass_stats.frame_number + 1;
+    pass_stats.num_set_immediates = 0;
+    pass_stats.num_passes = 0;
+    pass_stats.reached_pass_limit = false;
+    pass_stats.pass_reasons.clear();
+    repaint_flags.fetch_or(IS_PAINTING);
+    glyph_atlas_cache_begin_frame(vg, pixel_ratio);
+    glyph_rasterizer_begin_frame();
 
     while (true) {
+        glyph_rasterizer_finish_jobs(vg);
         nvgBeginFrame(vg, width, height, pixel_ratio);
         update_pre(width, height, pixel_ratio);
         update_proc();
         update_post();
 
-        repaint_mutex.lock();
-        is_painting = should_repaint;
-        repaint_mutex.unlock();
-        if (!is_painting) {
+        pass_stats.num_passes += 1;
+
+        // Stop painting unless another pass was asked for. Both flags
+        // change in one step, so a request from another thread either
+        // makes it into this frame or posts a message for the next one.
+        auto flags = repaint_flags.load();
+        while (!(flags & SHOULD_REPAINT) &&
+               !repaint_flags.compare_exchange_weak(flags, flags & ~IS_PAINTING)) {
+        }
+        if (!(flags & SHOULD_REPAINT)) {
+            break;
+        }
+        if (pass_stats.num_passes >= max_passes_per_frame) {
+            // Draw this pass, and leave the rest for the next frame
+            repaint_flags.fetch_and(~IS_PAINTING);
+            pass_stats.reached_pass_limit = true;
+            dirty_all = true;
             break;
         }
 
@@ -200,48 +300,196 @@ void update(float width, float height, float pixel_ratio, std::function<void()>
         nvgCancelFrame(vg);
     }
 
-    nvgEndFrame(vg);
+    // Clear the part of the frame that is redrawn. The draw calls
+    // are only flushed by nvgEndFrame, so they end up on top of this.
+    auto clear_x = frame_clear_rect[0];
+    auto clear_y = frame_clear_rect[1];
+    auto clear_width  = frame_clear_rect[2];
+    auto clear_height = frame_clear_rect[3];
+    nvgClearFramebuffer(vg, clear_x, clear_y, clear_width, clear_height, nvgRGBAf(0.949f, 0.949f, 0.949f, 1.0f));
+
+    {
+        DDUI_PROFILE_SCOPE("nvgEndFrame");
+        nvgEndFrame(vg);
+    }
+    auto presented = nvgPresentPersistentFramebuffer(vg, frame_buffer_width, frame_buffer_height);
+    pass_stats.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    update_render_stats();
+    update_repaint_reasons(pass_stats);
+    std::swap(pass_stats, last_pass_stats);
+    if (last_pass_stats.reached_pass_limit) {
+        request_repaint(NULL);
+    }
+    if (glyph_rasterizer_end_frame()) {
+        // Glyphs were left over by the upload budget, or arrived during the frame
+        repaint("glyph_rasterizer");
+    }
 
     #ifdef DDUI_PROFILING_ON
+        if (!presented) {
+            profiling::num_skipped_frames += 1;
+        }
         profiling::frame_end();
     #endif
 
+    return presented;
+}
+
+const unsigned char* read_framebuffer(int* width, int* height) {
+#if defined(DDUI_BACKEND_SOFTWARE)
+    return nvgswFramebuffer(vg, width, height);
+#elif defined(DDUI_BACKEND_NULL) || defined(_WIN32)
+    *width = 0;
+    *height = 0;
+    return NULL;
+#else
+    *width = frame_buffer_width;
+    *height = frame_buffer_height;
+
+    auto row_size = frame_buffer_width * 4;
+    read_framebuffer_pixels.resize(row_size * frame_buffer_height);
+    if (read_framebuffer_pixels.empty()) {
+        return NULL;
+    }
+
+    // The window's back buffer is undefined once it has been swapped, so
+    // the frame is read from the framebuffer it was drawn into
+    nvgBindPersistentReadFramebuffer(vg);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, frame_buffer_width, frame_buffer_height, GL_RGBA, GL_UNSIGNED_BYTE, read_framebuffer_pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    // GL returns the bottom row first
+    std::vector<unsigned char> row(row_size);
+    for (int y = 0; y < frame_buffer_height / 2; ++y) {
+        auto top = &read_framebuffer_pixels[y * row_size];
+        auto bottom = &read_framebuffer_pixels[(frame_buffer_height - 1 - y) * row_size];
+        memcpy(row.data(), top, row_size);
+        memcpy(top, bottom, row_size);
+        memcpy(bottom, row.data(), row_size);
+    }
+
+    return read_framebuffer_pixels.data();
+#endif
+}
+
+static bool is_mouse_move_unseen(float width, float height, float pixel_ratio) {
+    if (hover_tracks_mouse ||
+        mouse_state.pressed ||
+        mouse_state.pressed_secondary ||
+        animation::is_animating()) {
+        return false;
+    }
+
+    // The frame must be for the same window, and for
+    // nothing else than the mouse move
+    if (width != frame_width ||
+        height != frame_height ||
+        pixel_ratio != frame_pixel_ratio) {
+        return false;
+    }
+
+    int x, y;
+    if (!has_only_mouse_position_events(&x, &y)) {
+        return false;
+    }
+
+    if (!set_immediate_queue.empty()) {
+        return false;
+    }
+
+    repaint_mutex.lock();
+    auto is_dirty = dirty_all || has_dirty_rect;
+    repaint_mutex.unlock();
+    if (is_dirty) {
+        return false;
+    }
+
+    for (auto& region : hover_regions) {
+        auto& bounds = region.bounds;
+        auto was_inside = (bounds[0] <= mouse_state.x && mouse_state.x < bounds[2] &&
+                           bounds[1] <= mouse_state.y && mouse_state.y < bounds[3]);
+        auto is_inside  = (bounds[0] <= x && x < bounds[2] &&
+                           bounds[1] <= y && y < bounds[3]);
+        if (was_inside != is_inside) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
+static void update_cached_views();
+static void update_dirty_region(float pixel_ratio);
+static void apply_dirty_region(float pixel_ratio);
+
 void update_pre(float width, float height, float pixel_ratio) {
+    DDUI_PROFILE_SCOPE("update_pre");
 
     // Process all set_immediate callbacks
-    while (true) {
-        set_immediate_mutex.lock();
-        auto callbacks = std::move(set_immediate_callbacks);
-        set_immediate_mutex.unlock();
+    std::function<void()> callback;
+    while (set_immediate_queue.pop(&callback)) {
+        pass_stats.num_set_immediates += 1;
         #ifdef DDUI_PROFILING_ON
-            profiling::num_set_immediates += callbacks.size();
+            profiling::num_set_immediates += 1;
         #endif
-        for (auto& callback : callbacks) {
-            callback();
-        }
-        if (callbacks.empty()) {
-            break;
+        auto region_repaint_calls = num_region_repaint_calls.load();
+
+        callback();
+        callback = nullptr;
+
+        // A callback that didn't say which part of the
+        // window it changed could have changed all of it
+        if (num_region_repaint_calls.load() == region_repaint_calls) {
+            dirty_all = true;
         }
     }
 
-    // Reset should_repaint
-    repaint_mutex.lock();
-    should_repaint = false;
-    repaint_mutex.unlock();
+    // Reset should_repaint. A callback that was still being
+    // queued while we emptied the queue gets a pass of its own.
+    repaint_flags.fetch_and(~SHOULD_REPAINT);
+    if (!set_immediate_queue.empty()) {
+        repaint_flags.fetch_or(SHOULD_REPAINT);
+    }
+    if (pass_stats.pass_reasons.size() > pass_stats.num_passes) {
+        pass_stats.pass_reasons[pass_stats.num_passes].clear();
+    }
 
     // Let the animation system know that a new frame is being generated
     update_animation();
 
+    // Drop cached views that weren't used in the last frame
+    update_cached_views();
+
     cursor_state_new = CURSOR_ARROW;
 
+    auto prev_mouse_state = mouse_state;
     pop_input_events_into_global_state();
 
+    // Any input can change anything
+    if (mouse_state.x != prev_mouse_state.x ||
+        mouse_state.y != prev_mouse_state.y ||
+        mouse_state.pressed != prev_mouse_state.pressed ||
+        mouse_state.pressed_secondary != prev_mouse_state.pressed_secondary ||
+        mouse_state.scroll_dx != 0 ||
+        mouse_state.scroll_dy != 0 ||
+        key_state.action != 0 ||
+        key_state.character != NULL ||
+        file_drop_state.count != 0) {
+        dirty_all = true;
+    }
+
+    hover_regions.clear();
+    hover_tracks_mouse = false;
+
+    update_dirty_region(pixel_ratio);
+
     focus_state.action = FocusState::NO_CHANGE;
     focus_state.items.clear();
     focus_state.current.clear();
 
+    frame_pixel_ratio = pixel_ratio;
     view.width = width;
     view.height = height;
     saved_views.clear();
@@ -249,6 +497,7 @@ void update_pre(float width, float height, float pixel_ratio) {
 }
 
 void update_post() {
+    DDUI_PROFILE_SCOPE("update_post");
 
     #ifdef DDUI_PROFILING_ON
         profiling::num_repaints += 1;
@@ -315,7 +564,9 @@ void update_post() {
 
     if (focus_state.focus_old != focus_state.focus_new ||
         has_input_events_to_process()) {
-        should_repaint = true;
+        add_pass_reason(focus_state.focus_old != focus_state.focus_new ? "ddui::focus_change" : "ddui::pending_input");
+        repaint_flags.fetch_or(SHOULD_REPAINT);
+        dirty_all = true;
     }
 
     // Update cursor
@@ -326,25 +577,131 @@ void update_post() {
         }
     }
 
-    // Call all post_update callbacks
-    set_post_update_mutex.lock();
-    auto callbacks = std::move(set_post_update_callbacks);
-    set_post_update_mutex.unlock();
-    for (auto& callback : callbacks) {
+    // Call all post_update callbacks. The ones that are
+    // added while these run are left for the next frame.
+    std::function<void()> callback;
+    while (set_post_update_queue.pop(&callback)) {
+        post_update_callbacks.push_back(std::move(callback));
+    }
+    for (auto& callback : post_update_callbacks) {
         callback();
     }
+    post_update_callbacks.clear();
 }
 
-void repaint(const char* reason) {
+static void update_dirty_region(float pixel_ratio) {
+    auto is_animating = animation::is_animating();
+
     repaint_mutex.lock();
-    if (is_painting) {
-        should_repaint = true;
+    if (dirty_all.exchange(false) || is_animating) {
+        frame_dirty_all = true;
+    }
+    if (has_dirty_rect) {
+        if (!frame_has_dirty_rect) {
+            memcpy(frame_dirty_rect, dirty_rect, sizeof(frame_dirty_rect));
+            frame_has_dirty_rect = true;
+        } else {
+            frame_dirty_rect[0] = std::min(frame_dirty_rect[0], dirty_rect[0]);
+            frame_dirty_rect[1] = std::min(frame_dirty_rect[1], dirty_rect[1]);
+            frame_dirty_rect[2] = std::max(frame_dirty_rect[2], dirty_rect[2]);
+            frame_dirty_rect[3] = std::max(frame_dirty_rect[3], dirty_rect[3]);
+        }
+    }
+    has_dirty_rect = false;
+    repaint_mutex.unlock();
 
-        #ifdef DDUI_PROFILING_ON
-            if (reason != NULL) {
-                profiling::repaint_reason(reason);
-            }
-        #endif
+    apply_dirty_region(pixel_ratio);
+}
+
+static void apply_dirty_region(float pixel_ratio) {
+    // A frame that nobody asked for, e.g. because the window was
+    // exposed, is drawn in full
+    if (frame_dirty_all || !frame_has_dirty_rect) {
+        frame_is_partial = false;
+        frame_clear_rect[0] = 0;
+        frame_clear_rect[1] = 0;
+        frame_clear_rect[2] = frame_buffer_width;
+        frame_clear_rect[3] = frame_buffer_height;
+        nvgResetCullRect(vg);
+        render_recorder_set_clip(NULL);
+        return;
+    }
+
+    // Round out to whole pixels, with a pixel to spare for antialiasing
+    auto x0 = std::max(0, (int)floorf(frame_dirty_rect[0] * pixel_ratio) - 1);
+    auto y0 = std::max(0, (int)floorf(frame_dirty_rect[1] * pixel_ratio) - 1);
+    auto x1 = std::min(frame_buffer_width,  (int)ceilf(frame_dirty_rect[2] * pixel_ratio) + 1);
+    auto y1 = std::min(frame_buffer_height, (int)ceilf(frame_dirty_rect[3] * pixel_ratio) + 1);
+    x1 = std::max(x0, x1);
+    y1 = std::max(y0, y1);
+
+    frame_is_partial = true;
+    frame_clear_rect[0] = x0;
+    frame_clear_rect[1] = y0;
+    frame_clear_rect[2] = x1 - x0;
+    frame_clear_rect[3] = y1 - y0;
+
+    // Paths outside of the region are dropped by nanovg, and whatever
+    // crosses its edges is clipped before it reaches the backend
+    auto x = x0 / pixel_ratio;
+    auto y = y0 / pixel_ratio;
+    auto w = (x1 - x0) / pixel_ratio;
+    auto h = (y1 - y0) / pixel_ratio;
+    nvgCullRect(vg, x, y, w, h);
+
+    NVGscissor clip;
+    nvgTransformIdentity(clip.xform);
+    clip.xform[4] = x + w * 0.5f;
+    clip.xform[5] = y + h * 0.5f;
+    clip.extent[0] = w * 0.5f;
+    clip.extent[1] = h * 0.5f;
+    render_recorder_set_clip(&clip);
+}
+
+static bool is_outside_dirty_region(float x0, float y0, float x1, float y1) {
+    if (!frame_is_partial) {
+        return false;
+    }
+    auto pixel_ratio = frame_pixel_ratio;
+    return (x1 * pixel_ratio <= frame_clear_rect[0] ||
+            y1 * pixel_ratio <= frame_clear_rect[1] ||
+            x0 * pixel_ratio >= frame_clear_rect[0] + frame_clear_rect[2] ||
+            y0 * pixel_ratio >= frame_clear_rect[1] + frame_clear_rect[3]);
+}
+
+// Only called from the thread that is painting
+static void add_pass_reason(const char* reason) {
+    if (reason == NULL) {
+        return;
+    }
+    auto pass = (size_t)pass_stats.num_passes;
+    if (pass_stats.pass_reasons.size() <= pass) {
+        pass_stats.pass_reasons.resize(pass + 1);
+    }
+    pass_stats.pass_reasons[pass].push_back(reason);
+}
+
+static void request_repaint(const char* reason) {
+    // Passes keep the counted copy, as the caller's text may not outlive
+    // the frame
+    if (auto counted_reason = count_repaint_reason(reason)) {
+        reason = counted_reason;
+    }
+
+    auto flags = repaint_flags.fetch_or(SHOULD_REPAINT);
+    if (flags & IS_PAINTING) {
+        num_repaint_calls += 1;
+
+        // Reasons are kept for the passes of the painting thread only
+        if (is_paint_thread) {
+            add_pass_reason(reason);
+
+            #ifdef DDUI_PROFILING_ON
+                if (reason != NULL) {
+                    profiling::repaint_reason(reason);
+                }
+            #endif
+        }
 
     } else {
         if (post_empty_message_proc) {
@@ -353,20 +710,75 @@ void repaint(const char* reason) {
             printf("post_empty_message_proc not set! This is a crucial proc for ddui.\n");
         }
     }
+}
+
+void repaint(const char* reason) {
+    dirty_all = true;
+    request_repaint(reason);
+}
+
+void repaint(const char* reason, float x, float y, float width, float height) {
+    repaint_mutex.lock();
+    if (!has_dirty_rect) {
+        dirty_rect[0] = x;
+        dirty_rect[1] = y;
+        dirty_rect[2] = x + width;
+        dirty_rect[3] = y + height;
+        has_dirty_rect = true;
+    } else {
+        dirty_rect[0] = std::min(dirty_rect[0], x);
+        dirty_rect[1] = std::min(dirty_rect[1], y);
+        dirty_rect[2] = std::max(dirty_rect[2], x + width);
+        dirty_rect[3] = std::max(dirty_rect[3], y + height);
+    }
+    num_region_repaint_calls += 1;
     repaint_mutex.unlock();
+    request_repaint(reason);
+}
+
+void redraw_in_current_frame(float x, float y, float width, float height) {
+    if (!frame_is_partial) {
+        return;
+    }
+    frame_dirty_rect[0] = std::min(frame_dirty_rect[0], x);
+    frame_dirty_rect[1] = std::min(frame_dirty_rect[1], y);
+    frame_dirty_rect[2] = std::max(frame_dirty_rect[2], x + width);
+    frame_dirty_rect[3] = std::max(frame_dirty_rect[3], y + height);
+    apply_dirty_region(frame_pixel_ratio);
+}
+
+void set_max_passes_per_frame(int max_passes) {
+    max_passes_per_frame = max_passes < 1 ? 1 : max_passes;
+}
+
+const FramePassStats& get_frame_pass_stats() {
+    return last_pass_stats;
+}
+
+const RenderStats& get_render_stats() {
+    return render_stats;
+}
+
+void update_render_stats() {
+    auto stats = nvgInternalRenderStats(vg);
+    render_stats.num_calls = stats->calls;
+    render_stats.num_vertices = stats->vertices;
+    render_stats.uniform_bytes = stats->uniformBytes;
+    render_stats.texture_bytes = stats->textureBytes;
+    render_stats.num_convex_fills = stats->convexFills;
+    render_stats.num_stencil_fills = stats->stencilFills;
+    render_stats.num_glyph_misses = stats->glyphMisses;
+    render_stats.num_passes = pass_stats.num_passes;
+    memset(stats, 0, sizeof(*stats));
 }
 
 void set_immediate(std::function<void()> callback) {
-    set_immediate_mutex.lock();
-    set_immediate_callbacks.push_back(std::move(callback));
-    set_immediate_mutex.unlock();
-    repaint(NULL);
+    set_immediate_queue.push(std::move(callback));
+    request_repaint(NULL);
 }
 
 void set_post_update(std::function<void()> callback) {
-    set_post_update_mutex.lock();
-    set_post_update_callbacks.push_back(std::move(callback));
-    set_post_update_mutex.unlock();
+    set_post_update_queue.push(std::move(callback));
 }
 
 // Color utils
@@ -598,6 +1010,13 @@ bool rect_appears_in_clip_region(float x, float y, float width, float height) {
         x3 = x4; y3 = y1;                                          // top-right corner
     }
 
+    // Rectangles outside of the part of the window that is being
+    // redrawn don't appear anywhere
+    if (is_outside_dirty_region(std::min(x1, x4), std::min(y1, y4),
+                                std::max(x1, x4), std::max(y1, y4))) {
+        return false;
+    }
+
     // Step 2. Transform rectangle screen coordinates to scissor coordinates
     {
         float inv_xform[6];
@@ -743,6 +1162,9 @@ void text_box(float x, float y, float breakRowWidth, const char* string, const c
 }
 
 float text_bounds(float x, float y, const char* string, const char* end, float* bounds) {
+    if (x == 0 && y == 0) {
+        return cached_text_bounds(vg, string, end, bounds);
+    }
     return nvgTextBounds(vg, x, y, string, end, bounds);
 }
 
@@ -751,6 +1173,9 @@ void text_box_bounds(float x, float y, float breakRowWidth, const char* string,
 }
 
 int text_glyph_positions(float x, float y, const char* string, const char* end, GlyphPosition* positions, int maxPositions) {
+    if (x == 0 && y == 0) {
+        return cached_text_glyph_positions(vg, string, end, positions, maxPositions);
+    }
     return nvgTextGlyphPositions(vg, x, y, string, end, (NVGglyphPosition*)positions, maxPositions);
 }
 
@@ -758,6 +1183,44 @@ void text_metrics(float* ascender, float* descender, float* lineh) {
     nvgTextMetrics(vg, ascender, descender, lineh);
 }
 
+const FontAtlasStats& get_font_atlas_stats() {
+    NVGfontAtlasStats stats;
+    nvgFontAtlasStats(vg, &stats);
+    font_atlas_stats.num_pages = stats.pages;
+    font_atlas_stats.max_pages = stats.maxPages;
+    font_atlas_stats.num_bytes = stats.bytes;
+    font_atlas_stats.num_glyphs = stats.glyphs;
+    font_atlas_stats.num_evicted_glyphs = stats.evictedGlyphs;
+    font_atlas_stats.num_evicted_pages = stats.evictedPages;
+    font_atlas_stats.num_glyph_misses = stats.glyphMisses;
+    font_atlas_stats.num_pending_glyphs = stats.pendingGlyphs;
+    return font_atlas_stats;
+}
+
+void set_font_atlas_budget(int bytes) {
+    nvgFontAtlasBudget(vg, bytes);
+}
+
+void set_async_glyph_rasterization(bool enabled) {
+    glyph_rasterizer_set_enabled(vg, enabled);
+}
+
+void set_glyph_upload_budget(int bytes) {
+    glyph_rasterizer_set_upload_budget(bytes);
+}
+
+void enable_glyph_atlas_cache() {
+    glyph_atlas_cache_enable();
+}
+
+bool save_glyph_atlas_cache() {
+    return glyph_atlas_cache_save(vg, frame_pixel_ratio);
+}
+
+void prewarm_glyphs(const char* font, const std::vector<float>& sizes, const char* charset) {
+    glyph_atlas_cache_prewarm(font, sizes, charset);
+}
+
 // int text_break_lines(const char* string, const char* end, float breakRowWidth, NVGtextRow* rows, int maxRows);
 
 // Mouse state
@@ -811,8 +1274,7 @@ static bool is_point_inside_rect(float* xform, float* extent, float x, float y)
     );
 }
 
-static bool mouse_inside(float x, float y, float width, float height) {
-    float xform[6], extent[2];
+static void get_global_rect(float x, float y, float width, float height, float* xform, float* extent) {
     nvgCurrentTransform(vg, xform);
 
     extent[0] = width / 2;
@@ -821,11 +1283,22 @@ static bool mouse_inside(float x, float y, float width, float height) {
     nvgTransformPoint(&x, &y, xform, x + extent[0], y + extent[1]);
     xform[4] = x;
     xform[5] = y;
+}
+
+static bool is_point_inside_cached_view_clips(float x, float y);
+
+static bool mouse_inside(float x, float y, float width, float height) {
+    float xform[6], extent[2];
+    get_global_rect(x, y, width, height, xform, extent);
 
     if (!is_point_inside_rect(xform, extent, mouse_state.x, mouse_state.y)) {
         return false;
     }
 
+    if (!is_point_inside_cached_view_clips(mouse_state.x, mouse_state.y)) {
+        return false;
+    }
+
     auto scissor = get_scissor();
     if (scissor->extent[0] < 0) {
         return true;
@@ -834,11 +1307,25 @@ static bool mouse_inside(float x, float y, float width, float height) {
     return is_point_inside_rect(scissor->xform, scissor->extent, mouse_state.x, mouse_state.y);
 }
 
+struct CachedViewMouseRegion {
+    enum Kind {
+        OVER,
+        HIT,
+        HIT_SECONDARY
+    };
+    Kind kind;
+    float bounds[4];
+    bool result;
+    bool is_exact;
+};
+
+static bool record_mouse_region(CachedViewMouseRegion::Kind kind, float x, float y, float width, float height, bool result);
+
 bool mouse_hit(float x, float y, float width, float height) {
-    return (
+    return record_mouse_region(CachedViewMouseRegion::HIT, x, y, width, height, (
         !mouse_state.accepted && mouse_state.pressed &&
         mouse_inside(x, y, width, height)
-    );
+    ));
 }
 
 bool mouse_hit(float x, float y, float width, float height, bool* double_click_out) {
@@ -858,24 +1345,33 @@ bool mouse_hit(float x, float y, float width, float height, bool* double_click_o
 }
 
 bool mouse_hit_secondary(float x, float y, float width, float height) {
-    return (
+    return record_mouse_region(CachedViewMouseRegion::HIT_SECONDARY, x, y, width, height, (
         !mouse_state.accepted && mouse_state.pressed_secondary &&
         mouse_inside(x, y, width, height)
-    );
+    ));
 }
 
 bool mouse_over(float x, float y, float width, float height) {
-    return (
+    return record_mouse_region(CachedViewMouseRegion::OVER, x, y, width, height, (
         !mouse_state.accepted && !mouse_state.pressed &&
         mouse_inside(x, y, width, height)
-    );
+    ));
 }
 
 void mouse_hit_accept() {
     mouse_state.accepted = true;
 }
 
+static void mark_cached_view_volatile();
+
+void track_mouse() {
+    hover_tracks_mouse = true;
+    mark_cached_view_volatile();
+}
+
 void mouse_position(float* x, float* y) {
+    track_mouse();
+
     float mat[6], inv_mat[6];
     nvgCurrentTransform(vg, mat);
     nvgTransformInverse(inv_mat, mat);
@@ -883,6 +1379,8 @@ void mouse_position(float* x, float* y) {
 }
 
 void mouse_movement(float* x, float* y, float* dx, float* dy) {
+    track_mouse();
+
     float mat[6], inv_mat[6];
     nvgCurrentTransform(vg, mat);
     nvgTransformInverse(inv_mat, mat);
@@ -896,15 +1394,19 @@ void mouse_movement(float* x, float* y, float* dx, float* dy) {
 }
 
 // Focus state
+static void record_focus_item(const std::vector<const void*>& item);
+
 FocusItem::FocusItem(const void* identifier) {
     std::vector<const void*> item = focus_state.current;
     item.push_back(identifier);
     focus_state.items.push_back(item);
+    record_focus_item(item);
 }
 
 FocusGroup::FocusGroup(const void* identifier) {
     focus_state.current.push_back(identifier);
     focus_state.items.push_back(focus_state.current);
+    record_focus_item(focus_state.current);
 }
 
 FocusGroup::~FocusGroup() {
@@ -960,7 +1462,10 @@ const void* current_group() {
 }
 
 // Keyboard state
+static void record_input_use(bool key_events, bool dropped_files);
+
 bool has_key_event() {
+    record_input_use(true, false);
     return (key_state.character != NULL || key_state.key > 0);
 }
 
@@ -984,6 +1489,7 @@ void set_clipboard_string(const char* string) {
 
 // File drop state
 bool has_dropped_files() {
+    record_input_use(false, true);
     return (file_drop_state.count != 0);
 }
 void consume_dropped_files() {
@@ -991,11 +1497,441 @@ void consume_dropped_files() {
 }
 
 // Cursor state
+static void record_cursor(Cursor cursor);
+
 void set_cursor(Cursor cursor) {
     cursor_state_new = cursor;
+    record_cursor(cursor);
 }
 Cursor get_cursor() {
     return cursor_state_new;
 }
 
+// Cached views
+struct CachedView {
+    int version;
+    float width, height;
+    float scale_x, scale_y;
+    float alpha;
+    float pixel_ratio;
+    int font_atlas_generation;
+    bool pressed, pressed_secondary;
+    bool is_valid, is_volatile, touched;
+    bool uses_key_events, uses_dropped_files;
+    bool sets_cursor;
+    Cursor cursor;
+    RenderRecording recording;
+    std::vector<CachedViewMouseRegion> mouse_regions;
+    std::vector<std::vector<const void*>> focus_items;
+    std::vector<const void*> animations;
+};
+
+struct CachedViewFrame {
+    CachedView* cached_view;
+    float origin_x, origin_y;
+    int focus_depth;
+    NVGscissor clip;
+};
+
+static std::unordered_map<const void*, CachedView> cached_views;
+static std::vector<CachedViewFrame> cached_view_frames;
+
+static void update_cached_views() {
+    for (auto it = cached_views.begin(); it != cached_views.end();) {
+        if (!it->second.touched) {
+            it = cached_views.erase(it);
+        } else {
+            it->second.touched = false;
+            ++it;
+        }
+    }
+}
+
+static void get_bounds(const float* xform, const float* extent, float* bounds) {
+    auto half_width  = fabsf(xform[0]) * extent[0] + fabsf(xform[2]) * extent[1];
+    auto half_height = fabsf(xform[1]) * extent[0] + fabsf(xform[3]) * extent[1];
+    bounds[0] = xform[4] - half_width;
+    bounds[1] = xform[5] - half_height;
+    bounds[2] = xform[4] + half_width;
+    bounds[3] = xform[5] + half_height;
+}
+
+static bool is_point_inside_cached_view_clips(float x, float y) {
+    for (auto& frame : cached_view_frames) {
+        if (frame.clip.extent[0] >= 0 && !is_point_inside_rect(frame.clip.xform, frame.clip.extent, x, y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool is_axis_aligned(const float* xform) {
+    return xform[1] == 0.0f && xform[2] == 0.0f;
+}
+
+static void intersect_bounds(float* bounds, const float* xform, const float* extent) {
+    float clip_bounds[4];
+    get_bounds(xform, extent, clip_bounds);
+    bounds[0] = std::max(bounds[0], clip_bounds[0]);
+    bounds[1] = std::max(bounds[1], clip_bounds[1]);
+    bounds[2] = std::min(bounds[2], clip_bounds[2]);
+    bounds[3] = std::min(bounds[3], clip_bounds[3]);
+}
+
+static void add_hover_region(float* bounds, bool is_exact) {
+    // The mouse has to be inside of all the clips of
+    // the cached views that are being recorded too
+    for (auto& frame : cached_view_frames) {
+        if (frame.clip.extent[0] >= 0) {
+            is_exact = is_exact && is_axis_aligned(frame.clip.xform);
+            intersect_bounds(bounds, frame.clip.xform, frame.clip.extent);
+        }
+    }
+
+    // A bounding box that is bigger than the region could hide the
+    // mouse entering or leaving it, so those regions track every move
+    if (!is_exact) {
+        hover_tracks_mouse = true;
+        return;
+    }
+
+    HoverRegion region;
+    memcpy(region.bounds, bounds, sizeof(region.bounds));
+    hover_regions.push_back(region);
+}
+
+static bool record_mouse_region(CachedViewMouseRegion::Kind kind, float x, float y, float width, float height, bool result) {
+    float xform[6], extent[2], bounds[4];
+    get_global_rect(x, y, width, height, xform, extent);
+    get_bounds(xform, extent, bounds);
+    auto is_exact = is_axis_aligned(xform);
+
+    auto scissor = get_scissor();
+    if (scissor->extent[0] >= 0) {
+        is_exact = is_exact && is_axis_aligned(scissor->xform);
+        intersect_bounds(bounds, scissor->xform, scissor->extent);
+    }
+
+    CachedViewMouseRegion region;
+    region.kind = kind;
+    region.result = result;
+    region.is_exact = is_exact;
+    memcpy(region.bounds, bounds, sizeof(region.bounds));
+
+    add_hover_region(bounds, is_exact);
+
+    if (cached_view_frames.empty()) {
+        return result;
+    }
+    auto& frame = cached_view_frames.back();
+
+    region.bounds[0] -= frame.origin_x;
+    region.bounds[1] -= frame.origin_y;
+    region.bounds[2] -= frame.origin_x;
+    region.bounds[3] -= frame.origin_y;
+    frame.cached_view->mouse_regions.push_back(region);
+
+    return result;
+}
+
+static void mark_cached_view_volatile() {
+    if (!cached_view_frames.empty()) {
+        cached_view_frames.back().cached_view->is_volatile = true;
+    }
+}
+
+static void record_focus_item(const std::vector<const void*>& item) {
+    if (cached_view_frames.empty()) {
+        return;
+    }
+    auto& frame = cached_view_frames.back();
+    frame.cached_view->focus_items.emplace_back(item.begin() + frame.focus_depth, item.end());
+}
+
+static void record_input_use(bool key_events, bool dropped_files) {
+    if (cached_view_frames.empty()) {
+        return;
+    }
+    auto cached_view = cached_view_frames.back().cached_view;
+    cached_view->uses_key_events = cached_view->uses_key_events || key_events;
+    cached_view->uses_dropped_files = cached_view->uses_dropped_files || dropped_files;
+}
+
+static void add_animation(std::vector<const void*>& animations, const void* identifier) {
+    if (std::find(animations.begin(), animations.end(), identifier) == animations.end()) {
+        animations.push_back(identifier);
+    }
+}
+
+void record_animation_use(const void* identifier) {
+    if (cached_view_frames.empty()) {
+        return;
+    }
+    add_animation(cached_view_frames.back().cached_view->animations, identifier);
+}
+
+static bool has_running_animation(const CachedView& cached_view) {
+    for (auto identifier : cached_view.animations) {
+        if (is_animation_running(identifier)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void record_cursor(Cursor cursor) {
+    if (cached_view_frames.empty()) {
+        return;
+    }
+    auto cached_view = cached_view_frames.back().cached_view;
+    cached_view->sets_cursor = true;
+    cached_view->cursor = cursor;
+}
+
+// Hands what a nested cached view recorded or replayed to the cached view
+// that contains it, so that its own replays stay complete.
+static void merge_cached_view_into_parent(const CachedView& cached_view, float origin_x, float origin_y, int focus_depth) {
+    if (cached_view_frames.empty()) {
+        return;
+    }
+    auto& frame = cached_view_frames.back();
+    auto parent = frame.cached_view;
+
+    auto dx = origin_x - frame.origin_x;
+    auto dy = origin_y - frame.origin_y;
+    for (auto region : cached_view.mouse_regions) {
+        region.bounds[0] += dx;
+        region.bounds[1] += dy;
+        region.bounds[2] += dx;
+        region.bounds[3] += dy;
+        parent->mouse_regions.push_back(region);
+    }
+
+    for (auto& item : cached_view.focus_items) {
+        std::vector<const void*> parent_item(focus_state.current.begin() + frame.focus_depth,
+                                             focus_state.current.begin() + focus_depth);
+        parent_item.insert(parent_item.end(), item.begin(), item.end());
+        parent->focus_items.push_back(std::move(parent_item));
+    }
+
+    for (auto identifier : cached_view.animations) {
+        add_animation(parent->animations, identifier);
+    }
+
+    parent->is_volatile = parent->is_volatile || !cached_view.is_valid;
+    parent->uses_key_events = parent->uses_key_events || cached_view.uses_key_events;
+    parent->uses_dropped_files = parent->uses_dropped_files || cached_view.uses_dropped_files;
+    if (cached_view.sets_cursor) {
+        parent->sets_cursor = true;
+        parent->cursor = cached_view.cursor;
+    }
+}
+
+static bool is_focus_item(const std::vector<const void*>& focus, const std::vector<const void*>& item) {
+    auto depth = focus_state.current.size();
+    return (
+        focus.size() == depth + item.size() &&
+        std::equal(focus_state.current.begin(), focus_state.current.end(), focus.begin()) &&
+        std::equal(item.begin(), item.end(), focus.begin() + depth)
+    );
+}
+
+static bool can_replay_cached_view(const CachedView& cached_view, float origin_x, float origin_y, NVGscissor* clip) {
+    auto mouse_inside_clip = (
+        (clip->extent[0] < 0 || is_point_inside_rect(clip->xform, clip->extent, mouse_state.x, mouse_state.y)) &&
+        is_point_inside_cached_view_clips(mouse_state.x, mouse_state.y)
+    );
+
+    // Presses change the outcome of nearly every mouse query
+    if (mouse_state.pressed != cached_view.pressed ||
+        mouse_state.pressed_secondary != cached_view.pressed_secondary) {
+        return false;
+    }
+
+    // Scrolling goes to the views under the mouse
+    if ((mouse_state.scroll_dx != 0 || mouse_state.scroll_dy != 0) && mouse_inside_clip &&
+        origin_x <= mouse_state.x && mouse_state.x < origin_x + cached_view.width * cached_view.scale_x &&
+        origin_y <= mouse_state.y && mouse_state.y < origin_y + cached_view.height * cached_view.scale_y) {
+        return false;
+    }
+
+    if (cached_view.uses_key_events && (key_state.character != NULL || key_state.key > 0)) {
+        return false;
+    }
+
+    if (cached_view.uses_dropped_files && file_drop_state.count != 0) {
+        return false;
+    }
+
+    // Focused items need to see their key events
+    for (auto& item : cached_view.focus_items) {
+        if (is_focus_item(focus_state.focus_new, item) || is_focus_item(focus_state.focus_old, item)) {
+            return false;
+        }
+    }
+
+    // Every mouse query has to come out the same as when it was recorded
+    for (auto& region : cached_view.mouse_regions) {
+        auto x = mouse_state.x - origin_x;
+        auto y = mouse_state.y - origin_y;
+        auto inside = (
+            mouse_inside_clip &&
+            region.bounds[0] <= x && x < region.bounds[2] &&
+            region.bounds[1] <= y && y < region.bounds[3]
+        );
+
+        bool result = false;
+        switch (region.kind) {
+            case CachedViewMouseRegion::OVER:
+                result = !mouse_state.accepted && !mouse_state.pressed && inside;
+                break;
+            case CachedViewMouseRegion::HIT:
+                result = !mouse_state.accepted && mouse_state.pressed && inside;
+                break;
+            case CachedViewMouseRegion::HIT_SECONDARY:
+                result = !mouse_state.accepted && mouse_state.pressed_secondary && inside;
+                break;
+        }
+        if (result != region.result) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void cached_view(const void* identifier, int version, float width, float height, std::function<void()> update_proc) {
+    auto vg_ = (NVGcontext_*)vg;
+    auto& state = vg_->states[vg_->nstates - 1];
+
+    // Recordings can only be moved around, so rotated or skewed views
+    // are always drawn from scratch
+    if (state.xform[1] != 0.0f || state.xform[2] != 0.0f) {
+        sub_view(0, 0, width, height);
+        clip(0, 0, width, height);
+        update_proc();
+        restore();
+        return;
+    }
+
+    auto origin_x = state.xform[4];
+    auto origin_y = state.xform[5];
+    auto clip_scissor = state.scissor;
+
+    auto& cached_view = cached_views[identifier];
+    cached_view.touched = true;
+
+    if (cached_view.is_valid &&
+        cached_view.version == version &&
+        cached_view.width == width &&
+        cached_view.height == height &&
+        cached_view.scale_x == state.xform[0] &&
+        cached_view.scale_y == state.xform[3] &&
+        cached_view.alpha == state.alpha &&
+        cached_view.pixel_ratio == frame_pixel_ratio &&
+        cached_view.font_atlas_generation == nvgInternalFontAtlasGeneration(vg) &&
+        !has_running_animation(cached_view) &&
+        can_replay_cached_view(cached_view, origin_x, origin_y, &clip_scissor)) {
+
+        // Keep the animations it drew alive, as update_proc would have
+        for (auto identifier : cached_view.animations) {
+            touch_animation(identifier);
+        }
+
+        auto focus_depth = (int)focus_state.current.size();
+        for (auto& item : cached_view.focus_items) {
+            auto full_item = focus_state.current;
+            full_item.insert(full_item.end(), item.begin(), item.end());
+            focus_state.items.push_back(std::move(full_item));
+        }
+        if (cached_view.sets_cursor) {
+            cursor_state_new = cached_view.cursor;
+        }
+        for (auto& region : cached_view.mouse_regions) {
+            float bounds[4] = {
+                region.bounds[0] + origin_x,
+                region.bounds[1] + origin_y,
+                region.bounds[2] + origin_x,
+                region.bounds[3] + origin_y
+            };
+            auto is_exact = region.is_exact;
+            if (clip_scissor.extent[0] >= 0) {
+                is_exact = is_exact && is_axis_aligned(clip_scissor.xform);
+                intersect_bounds(bounds, clip_scissor.xform, clip_scissor.extent);
+            }
+            add_hover_region(bounds, is_exact);
+        }
+
+        if (!is_outside_dirty_region(origin_x, origin_y,
+                                     origin_x + width * state.xform[0],
+                                     origin_y + height * state.xform[3])) {
+            render_recorder_replay(&cached_view.recording, origin_x, origin_y, &clip_scissor);
+        }
+        merge_cached_view_into_parent(cached_view, origin_x, origin_y, focus_depth);
+        return;
+    }
+
+    // Record the view
+    cached_view.version = version;
+    cached_view.width = width;
+    cached_view.height = height;
+    cached_view.scale_x = state.xform[0];
+    cached_view.scale_y = state.xform[3];
+    cached_view.alpha = state.alpha;
+    cached_view.pixel_ratio = frame_pixel_ratio;
+    cached_view.pressed = mouse_state.pressed;
+    cached_view.pressed_secondary = mouse_state.pressed_secondary;
+    cached_view.is_volatile = false;
+    cached_view.uses_key_events = false;
+    cached_view.uses_dropped_files = false;
+    cached_view.sets_cursor = false;
+    cached_view.mouse_regions.clear();
+    cached_view.focus_items.clear();
+    cached_view.animations.clear();
+
+    CachedViewFrame frame;
+    frame.cached_view = &cached_view;
+    frame.origin_x = origin_x;
+    frame.origin_y = origin_y;
+    frame.focus_depth = (int)focus_state.current.size();
+    frame.clip = clip_scissor;
+    cached_view_frames.push_back(frame);
+
+    auto repaint_calls = num_repaint_calls.load();
+
+    // The view is drawn in full and clipped to its own bounds here, the
+    // outside clip is applied by the recorder
+    save();
+    view.width = width;
+    view.height = height;
+    nvgScissor(vg, 0, 0, width, height);
+    render_recorder_begin(&cached_view.recording, origin_x, origin_y, &clip_scissor);
+    // The recording must be complete to be replayed in later frames
+    auto is_culling = frame_is_partial && cached_view_frames.size() == 1;
+    if (is_culling) {
+        nvgResetCullRect(vg);
+    }
+    update_proc();
+    if (is_culling) {
+        nvgCullRect(vg, frame_clear_rect[0] / frame_pixel_ratio,
+                        frame_clear_rect[1] / frame_pixel_ratio,
+                        frame_clear_rect[2] / frame_pixel_ratio,
+                        frame_clear_rect[3] / frame_pixel_ratio);
+    }
+    render_recorder_end();
+    restore();
+
+    cached_view_frames.pop_back();
+
+    // Views that asked for another pass are animating, and so are views
+    // with animations that haven't finished, which don't ask for one
+    auto did_repaint = (num_repaint_calls.load() != repaint_calls);
+    auto is_animating = has_running_animation(cached_view);
+
+    cached_view.font_atlas_generation = nvgInternalFontAtlasGeneration(vg);
+    cached_view.is_valid = !cached_view.is_volatile && !did_repaint && !is_animating;
+
+    merge_cached_view_into_parent(cached_view, origin_x, origin_y, frame.focus_depth);
+}
+
 }
@@ -10,6 +10,7 @@
 #define ddui_core_hpp
 
 #include <functional>
+#include <vector>
 #include <chrono>
 #include "glfw.hpp"
 
@@ -280,11 +281,97 @@ void input_scroll(float offset_x, float offset_y);
 void input_file_drop(int count, const char** paths);
 
 // Frame management
-void update(float width, float height, float pixel_ratio, std::function<void()> update_proc);
+// Returns false if the frame turned out identical to the previous one, in
+// which case nothing was drawn and there is no need to swap buffers.
+bool update(float width, float height, float pixel_ratio, std::function<void()> update_proc);
 void repaint(const char* reason);
+
+// Like repaint(), but only the given rectangle, in global coordinates, has
+// changed. As long as nothing else asks for a repaint, the next frame only
+// clears and redraws the union of these rectangles, and skips the drawing
+// of everything outside of it.
+void repaint(const char* reason, float x, float y, float width, float height);
+
+// Adds a rectangle, in global coordinates, to the part of the window that
+// the frame being drawn redraws, without asking for a frame of its own.
+// For views that change whenever anything is drawn. It has to be called
+// in update_proc before anything is drawn, as whatever was drawn earlier
+// in the pass was only kept where it fell inside the old region.
+void redraw_in_current_frame(float x, float y, float width, float height);
 void set_immediate(std::function<void()> callback);
 void set_post_update(std::function<void()> callback);
 
+// update() runs update_proc again for as long as something asks for a
+// repaint while it runs. This limits the number of passes in one frame:
+// the pass that reaches it is drawn as is, and the repaint it asked for
+// carries over to the next frame. Defaults to 10.
+void set_max_passes_per_frame(int max_passes);
+
+struct FramePassStats {
+    long frame_number;       // counts the frames drawn so far
+    double duration;         // seconds update() took, presenting included
+    int num_set_immediates;  // set_immediate callbacks run over all passes
+    int num_passes;
+    bool reached_pass_limit;
+    // The reasons given to repaint() in each pass that asked for another
+    // pass, indexed by pass. Reasons point to copies of their text that
+    // are never freed, except past the first 4096 different reasons, which
+    // point to the caller's text.
+    std::vector<std::vector<const char*>> pass_reasons;
+};
+
+// Returns the passes of the last frame, what caused them, and how long
+// the frame took.
+const FramePassStats& get_frame_pass_stats();
+
+struct RenderStats {
+    int num_calls;          // fill, stroke and triangle calls sent to the GPU
+    int num_vertices;       // vertices uploaded
+    int uniform_bytes;      // fragment uniform bytes uploaded
+    int texture_bytes;      // texture bytes uploaded, font atlas included
+    int num_convex_fills;   // fills drawn directly
+    int num_stencil_fills;  // fills drawn through the stencil buffer
+    int num_glyph_misses;   // glyphs that weren't in the font cache
+    int num_passes;
+};
+
+// Returns what the last frame sent to the GPU. Work done between frames,
+// like creating images, counts towards the next frame. Passes that were
+// thrown away for another pass only count through num_glyph_misses.
+const RenderStats& get_render_stats();
+
+struct RepaintReasonStats {
+    const char* reason;
+    long num_calls;          // calls to repaint() with this reason
+    long num_frames;         // frames it asked for, or was part of
+    long num_extra_passes;   // passes it added to the frames it was part of
+    float frames_per_second; // frames over the last second
+};
+
+// Returns the counters of every reason that has been given to repaint().
+// Reasons with the same text share counters, whether or not they are
+// string literals, up to 4096 different reasons. These are always kept,
+// and are cheap enough to leave on in release builds.
+std::vector<RepaintReasonStats> get_repaint_reason_stats();
+
+struct RepaintStorm {
+    const char* reason;
+    float frames_per_second;
+    int num_extra_passes;    // extra passes it caused in the last frame
+};
+
+// Calls handler after a frame in which one reason has asked for more than
+// max_frames_per_second frames over the last second, or for more than
+// max_extra_passes extra passes. It is called at most once a second for
+// each reason, on the thread that paints. Pass nullptr to turn it off.
+void set_repaint_storm_handler(float max_frames_per_second, int max_extra_passes,
+                               std::function<void(const RepaintStorm&)> handler);
+
+// Returns the pixels of the last frame as RGBA rows, top row first, or NULL
+// if the backend can't read them back. Call after update(). The pointer is
+// valid until the next frame.
+const unsigned char* read_framebuffer(int* width, int* height);
+
 // Color utils
 Color rgb(unsigned char r, unsigned char g, unsigned char b);
 Color rgb(unsigned int rgb);
@@ -302,6 +389,16 @@ void restore();
 void reset();
 void sub_view(float x, float y, float width, float height);
 
+// Runs update_proc in a view of the given size at the current position,
+// clipped to its bounds. The draw calls, mouse regions and focus items it
+// produces are kept and replayed in later frames instead of calling
+// update_proc, for as long as the identifier and version stay the same
+// and no input arrives that update_proc would respond to. Change version
+// whenever anything update_proc draws changes. Animations are tracked for
+// you: while one that update_proc used is running, update_proc is called
+// every frame, and replays keep the animations it used alive.
+void cached_view(const void* identifier, int version, float width, float height, std::function<void()> update_proc);
+
 // Render styles
 // void shape_anti_alias(bool enabled);
 void stroke_color(Color color);
@@ -373,6 +470,76 @@ void text_box_bounds(float x, float y, float breakRowWidth, const char* string,
 int text_glyph_positions(float x, float y, const char* string, const char* end, GlyphPosition* positions, int maxPositions);
 void text_metrics(float* ascender, float* descender, float* lineh);
 
+struct TextMeasurementCacheStats {
+    long num_hits;
+    long num_misses;
+    long num_evictions;  // entries dropped to make room for others
+    int num_entries;
+    int capacity;
+    float hit_rate;      // hits over all lookups so far
+};
+
+// text_bounds() and text_glyph_positions() keep the measurements of strings
+// measured at the origin, for the same font, size, letter spacing and scale,
+// in an LRU cache. Once it is full, a string only displaces the least
+// recently used one if it has been measured more often lately. It is
+// emptied whenever a font or fallback font is added.
+const TextMeasurementCacheStats& get_text_measurement_cache_stats();
+
+// Sets the number of measurements kept, 0 turning the cache off. Defaults
+// to 4096.
+void set_text_measurement_cache_capacity(int capacity);
+
+struct FontAtlasStats {
+    int num_pages;           // atlas pages, each a texture of its own
+    int max_pages;           // pages that fit the budget
+    int num_bytes;           // bytes of glyph textures
+    int num_glyphs;          // glyphs in the atlas
+    int num_evicted_glyphs;  // glyphs evicted so far
+    int num_evicted_pages;   // pages evicted so far
+    int num_glyph_misses;    // glyph lookups that missed so far
+    int num_pending_glyphs;  // glyphs being rasterized on worker threads
+};
+
+// Glyphs are rasterized into atlas pages of 512x512, which are added as
+// needed up to the budget. Beyond that, the page drawn from least in the
+// recent frames is evicted, and its glyphs are rasterized again when drawn.
+const FontAtlasStats& get_font_atlas_stats();
+
+// Sets the bytes of glyph textures kept, at least one page. Defaults to
+// 4 MB.
+void set_font_atlas_budget(int bytes);
+
+// Rasterizes glyphs that aren't in the font atlas on worker threads, instead
+// of in the middle of drawing text. Until a glyph arrives, text is drawn with
+// the same glyph at another size, or without it, and a repaint follows once
+// it's ready. Off by default.
+void set_async_glyph_rasterization(bool enabled);
+
+// Sets the bytes of glyphs rasterized on worker threads that go into the
+// font atlas in one frame. The rest wait for the next frame. Defaults to
+// 256 KB.
+void set_glyph_upload_budget(int bytes);
+
+// Keeps the glyphs of the font atlas across runs, in a file in the content
+// directory, so that the first frames don't have to rasterize them again.
+// The file is mapped by init() and loaded in the first frame, if it was
+// saved at the same pixel ratio by the same version of ddui. Only glyphs of
+// fonts created before the first frame, from the same files, are loaded.
+// Call before init().
+void enable_glyph_atlas_cache();
+
+// Saves the glyphs in the font atlas to the cache file, e.g. once the
+// first screens have been drawn. Call between frames. Returns false if the
+// file couldn't be written.
+bool save_glyph_atlas_cache();
+
+// Puts the glyphs of charset, a UTF-8 string, into the font atlas at each
+// of the sizes at the start of the next frame, so that a startup screen
+// doesn't rasterize them as it draws. Glyphs loaded from the cache are
+// left as they are.
+void prewarm_glyphs(const char* font, const std::vector<float>& sizes, const char* charset);
+
 // Mouse state
 extern MouseState mouse_state;
 bool mouse_hit(float x, float y, float width, float height);
@@ -382,6 +549,13 @@ bool mouse_over(float x, float y, float width, float height);
 void mouse_hit_accept();
 void mouse_position(float* x, float* y);
 void mouse_movement(float* x, float* y, float* dx, float* dy);
+
+// Mouse moves only lead to a new frame when the mouse enters or leaves one
+// of the regions that mouse_over() and mouse_hit() tested in the last frame.
+// Views that follow the mouse in some other way, e.g. by reading mouse_state
+// directly while dragging, call track_mouse() to get a frame for every move.
+// mouse_position() and mouse_movement() do this already.
+void track_mouse();
 void perform_window_drag();
 
 // Focus state
@@ -430,19 +604,35 @@ Cursor get_cursor();
 // Animation
 namespace animation {
     void start(const void* identifier);
+
+    // Starts an animation that only needs a new frame every update_interval
+    // seconds (e.g. 1.0 / 30 for a spinner or 1.0 for a clock). While only
+    // such animations are running, app_run() sleeps until the earliest one
+    // is due instead of drawing at the display's refresh rate.
+    void start(const void* identifier, double update_interval);
     void stop(const void* identifier);
     bool is_animating(const void* identifier);
     double get_time_elapsed(const void* identifier);
     double ease_in(double completion);
     double ease_out(double completion);
     double ease_in_out(double completion);
+
+    // Returns the value of a tween from `from` to `to` over `duration`
+    // seconds, which starts the first time it's called. Calling it with
+    // a different `to` tweens from the current value to the new one.
+    // The values of all tweens are worked out together once per frame,
+    // and a finished tween stops asking for frames.
+    double tween(const void* identifier, double from, double to, double duration,
+                 double (*easing)(double) = NULL);
     bool is_animating();
 }
 
 // Timers
+// A timer with a leeway may fire up to that many milliseconds late, so
+// that timers which come due around the same time share a single frame.
 namespace timer {
-    int set_timeout(std::function<void()> callback, long time_in_ms);
-    int set_interval(std::function<void()> callback, long time_in_ms);
+    int set_timeout(std::function<void()> callback, long time_in_ms, long leeway_in_ms = 0);
+    int set_interval(std::function<void()> callback, long time_in_ms, long leeway_in_ms = 0);
     void clear_timeout(int timeout_id);
     void clear_interval(int interval_id);
 }
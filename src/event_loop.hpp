@@ -0,0 +1,40 @@
+//
+//  event_loop.hpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#ifndef ddui_event_loop_hpp
+#define ddui_event_loop_hpp
+
+#include "glfw.hpp"
+
+namespace ddui {
+
+// The Linux event loop for app_run(). Instead of glfwWaitEvents() it waits
+// in a single epoll on the X11 connection, a timerfd that is armed for the
+// next ddui::timer deadline, an eventfd that other threads write to when
+// they post a message to the UI thread, and the fds registered with
+// app_watch_fd(). Once the loop takes over the timers, their deadlines are
+// waited for by the UI thread, so the timer thread no longer has to wake up
+// for them. Timers that are due are still queued with set_immediate, which
+// writes to the eventfd, and that write is drained before the loop returns.
+//
+// event_loop_init() returns false if the loop can't be used, e.g. when
+// GLFW isn't running on X11, in which case app_run() keeps using GLFW. It
+// replaces the proc that posts messages to the UI thread, so it has to be
+// called before ddui::init() starts any other thread that could post one.
+bool event_loop_init(GLFWwindow* window);
+
+// Hands the timers over to the loop. Needs ddui::init() to have been called.
+void event_loop_take_over_timers();
+
+// Waits for an event, or for timeout seconds if timeout isn't negative,
+// and then processes the GLFW events.
+void event_loop_wait(double timeout);
+
+}
+
+#endif
@@ -0,0 +1,217 @@
+//
+//  event_loop.linux.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "event_loop.hpp"
+#include "app.hpp"
+#include "core.hpp"
+#include "timer.hpp"
+#include <unordered_map>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+
+#define GLFW_EXPOSE_NATIVE_X11
+#include <GLFW/glfw3native.h>
+
+namespace ddui {
+
+struct WatchedFd {
+    int events;
+    std::function<void(int events)> callback;
+};
+
+static const int MAX_EVENTS = 32;
+
+static int epoll_fd = -1;
+static int wake_fd = -1;
+static int timer_fd = -1;
+static int x11_fd = -1;
+static Display* x11_display;
+static std::unordered_map<int, WatchedFd> watched_fds;
+
+static void wake();
+static void drain(int fd);
+static void arm_timer(double timeout);
+static bool add_to_epoll(int fd, int events);
+static unsigned int to_epoll_events(int events);
+
+bool event_loop_init(GLFWwindow* window) {
+    x11_display = glfwGetX11Display();
+    if (!x11_display) {
+        return false;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    x11_fd = ConnectionNumber(x11_display);
+    if (epoll_fd == -1 || wake_fd == -1 || timer_fd == -1 ||
+        !add_to_epoll(wake_fd, APP_FD_READABLE) ||
+        !add_to_epoll(timer_fd, APP_FD_READABLE) ||
+        !add_to_epoll(x11_fd, APP_FD_READABLE)) {
+        printf("Could not set up the epoll event loop (errno %d), using GLFW's instead.\n", errno);
+        if (epoll_fd != -1) close(epoll_fd);
+        if (wake_fd != -1) close(wake_fd);
+        if (timer_fd != -1) close(timer_fd);
+        epoll_fd = -1;
+        return false;
+    }
+
+    // Fds that were watched before the loop existed
+    for (auto& entry : watched_fds) {
+        add_to_epoll(entry.first, entry.second.events);
+    }
+
+    set_post_empty_message_proc(wake);
+
+    return true;
+}
+
+void event_loop_take_over_timers() {
+    timer_use_event_loop(wake);
+}
+
+void event_loop_wait(double timeout) {
+
+    // Events that Xlib has already read off the connection
+    // won't show up on the fd, so don't wait if there are any
+    if (XPending(x11_display)) {
+        timeout = 0.0;
+    }
+
+    arm_timer(timeout);
+
+    epoll_event events[MAX_EVENTS];
+    int num_events = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+
+    for (int i = 0; i < num_events; ++i) {
+        auto fd = events[i].data.fd;
+        if (fd == timer_fd) {
+            drain(timer_fd);
+            timer_dispatch();
+        } else if (fd == wake_fd || fd == x11_fd) {
+            // Handled below
+        } else {
+            // The callback may unwatch this or any other fd
+            auto it = watched_fds.find(fd);
+            if (it == watched_fds.end()) {
+                continue;
+            }
+            int ready = 0;
+            if (events[i].events & (EPOLLIN | EPOLLPRI)) {
+                ready |= APP_FD_READABLE;
+            }
+            if (events[i].events & EPOLLOUT) {
+                ready |= APP_FD_WRITABLE;
+            }
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                ready |= it->second.events;
+            }
+            auto callback = it->second.callback;
+            callback(ready);
+        }
+    }
+
+    glfwPollEvents();
+
+    // The frame that follows picks up anything that was posted until
+    // now, so a wake-up that is still pending would be for nothing
+    drain(wake_fd);
+}
+
+void app_watch_fd(int fd, int events, std::function<void(int events)> callback) {
+    auto is_watched = watched_fds.find(fd) != watched_fds.end();
+
+    WatchedFd watched_fd;
+    watched_fd.events = events;
+    watched_fd.callback = std::move(callback);
+    watched_fds[fd] = std::move(watched_fd);
+
+    if (epoll_fd == -1) {
+        return;
+    }
+    if (is_watched) {
+        epoll_event event = {};
+        event.events = to_epoll_events(events);
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event);
+    } else {
+        add_to_epoll(fd, events);
+    }
+}
+
+void app_unwatch_fd(int fd) {
+    if (watched_fds.erase(fd) == 0) {
+        return;
+    }
+    if (epoll_fd != -1) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    }
+}
+
+void wake() {
+    uint64_t value = 1;
+    auto result = write(wake_fd, &value, sizeof(value));
+    (void)result;
+}
+
+void drain(int fd) {
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) > 0) {
+    }
+}
+
+void arm_timer(double timeout) {
+    std::chrono::high_resolution_clock::time_point deadline;
+    auto has_deadline = timer_get_next_deadline(&deadline);
+
+    double wait_time = timeout;
+    if (has_deadline) {
+        auto time_to_deadline = std::chrono::duration_cast<std::chrono::duration<double>>(
+            deadline - std::chrono::high_resolution_clock::now()
+        ).count();
+        if (wait_time < 0.0 || wait_time > time_to_deadline) {
+            wait_time = time_to_deadline;
+        }
+    }
+
+    // A zero it_value disarms the timer, so wait at least a nanosecond
+    itimerspec spec = {};
+    if (wait_time >= 0.0 || has_deadline) {
+        auto nanoseconds = wait_time > 0.0 ? (long long)(wait_time * 1e9) : 1;
+        if (nanoseconds < 1) {
+            nanoseconds = 1;
+        }
+        spec.it_value.tv_sec = (time_t)(nanoseconds / 1000000000);
+        spec.it_value.tv_nsec = (long)(nanoseconds % 1000000000);
+    }
+    timerfd_settime(timer_fd, 0, &spec, NULL);
+}
+
+bool add_to_epoll(int fd, int events) {
+    epoll_event event = {};
+    event.events = to_epoll_events(events);
+    event.data.fd = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+unsigned int to_epoll_events(int events) {
+    unsigned int epoll_events = 0;
+    if (events & APP_FD_READABLE) {
+        epoll_events |= EPOLLIN;
+    }
+    if (events & APP_FD_WRITABLE) {
+        epoll_events |= EPOLLOUT;
+    }
+    return epoll_events;
+}
+
+}
@@ -143,12 +143,14 @@ void update_window(GLFWwindow* window) {
     ddui::input_mouse_position(xpos, ypos);
 #endif
 
-    ddui::update(win_width, win_height, pixel_ratio, *update_proc_ptr);
+    auto changed = ddui::update(win_width, win_height, pixel_ratio, *update_proc_ptr);
+    if (changed) {
 #ifdef _WIN32
-    ddui_state->swap_chain->Present(0, 0);
+        ddui_state->swap_chain->Present(0, 0);
 #else
-    glfwSwapBuffers(window);
+        glfwSwapBuffers(window);
 #endif
+    }
 
 #ifdef __APPLE__
     static bool fixed_mac_bug = false;
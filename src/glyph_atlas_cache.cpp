@@ -0,0 +1,200 @@
+//
+//  glyph_atlas_cache.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "glyph_atlas_cache.hpp"
+#include "profiling.hpp"
+#include <ddui/util/get_content_filename>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The cache file holds the font atlas as nanovg saves it, behind a header
+// with the pixel ratio it was drawn at. Glyphs are rasterized at the size
+// they're drawn at in device pixels, so a cache is only of use at the same
+// pixel ratio. The atlas data keys glyphs by a hash of the font files
+// themselves, so fonts that have changed don't pick up stale glyphs.
+//
+// The pixel ratio is only known once the first frame starts, so init()
+// maps the file, and the first frame loads it into the atlas before any
+// text is drawn, and unmaps it.
+struct Header {
+    char magic[8];
+    int version;
+    float pixel_ratio;
+    int size;
+};
+
+static const char MAGIC[8] = "ddglyph";
+
+// Bump whenever ddui starts rasterizing glyphs differently, so that caches
+// written by earlier builds are ignored
+static const int VERSION = 1;
+
+static const char* FILENAME = "glyph_atlas.cache";
+
+struct PrewarmRequest {
+    std::string font;
+    std::vector<float> sizes;
+    std::string charset;
+};
+
+static bool is_enabled;
+static bool is_first_frame = true;
+static const unsigned char* file_data;
+static size_t file_size;
+#ifdef _WIN32
+static std::vector<unsigned char> file_buffer;
+#endif
+static std::vector<PrewarmRequest> prewarm_requests;
+
+static void unmap_file();
+
+void glyph_atlas_cache_enable() {
+    is_enabled = true;
+}
+
+void glyph_atlas_cache_init() {
+    if (!is_enabled) {
+        return;
+    }
+    auto filename = get_content_filename(FILENAME);
+
+#ifdef _WIN32
+    auto fp = fopen(filename.c_str(), "rb");
+    if (!fp) {
+        return;
+    }
+    fseek(fp, 0, SEEK_END);
+    auto size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size > 0) {
+        file_buffer.resize(size);
+        if (fread(file_buffer.data(), 1, size, fp) == (size_t)size) {
+            file_data = file_buffer.data();
+            file_size = size;
+        }
+    }
+    fclose(fp);
+#else
+    auto fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        auto data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            file_data = (const unsigned char*)data;
+            file_size = st.st_size;
+        }
+    }
+    close(fd);
+#endif
+}
+
+void glyph_atlas_cache_terminate() {
+    unmap_file();
+}
+
+void unmap_file() {
+    if (!file_data) {
+        return;
+    }
+#ifdef _WIN32
+    file_buffer.clear();
+    file_buffer.shrink_to_fit();
+#else
+    munmap((void*)file_data, file_size);
+#endif
+    file_data = NULL;
+    file_size = 0;
+}
+
+void glyph_atlas_cache_begin_frame(NVGcontext* vg, float pixel_ratio) {
+    if (is_first_frame) {
+        is_first_frame = false;
+        if (file_data && file_size >= sizeof(Header)) {
+            DDUI_PROFILE_SCOPE("load glyph atlas cache");
+            Header header;
+            memcpy(&header, file_data, sizeof(header));
+            if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                header.version == VERSION &&
+                header.pixel_ratio == pixel_ratio &&
+                header.size > 0 && (size_t)header.size <= file_size - sizeof(Header)) {
+                nvgInternalLoadFontAtlas(vg, file_data + sizeof(Header), header.size);
+            }
+        }
+        unmap_file();
+    }
+
+    if (prewarm_requests.empty()) {
+        return;
+    }
+    DDUI_PROFILE_SCOPE("prewarm glyphs");
+    for (auto& request : prewarm_requests) {
+        auto font = nvgFindFont(vg, request.font.c_str());
+        for (auto size : request.sizes) {
+            nvgInternalPrewarmGlyphs(vg, font, size, pixel_ratio, request.charset.c_str(), NULL);
+        }
+    }
+    prewarm_requests.clear();
+}
+
+bool glyph_atlas_cache_save(NVGcontext* vg, float pixel_ratio) {
+    if (pixel_ratio <= 0) {
+        return false;
+    }
+
+    int size;
+    auto data = nvgInternalSaveFontAtlas(vg, &size);
+    if (!data) {
+        return false;
+    }
+
+    Header header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.pixel_ratio = pixel_ratio;
+    header.size = size;
+
+    // Written next to the cache and moved over it, so that a run that
+    // starts meanwhile never maps half a file
+    auto filename = get_content_filename(FILENAME);
+    auto temp_filename = filename + ".tmp";
+    auto fp = fopen(temp_filename.c_str(), "wb");
+    auto ok = (fp &&
+               fwrite(&header, sizeof(header), 1, fp) == 1 &&
+               fwrite(data, 1, size, fp) == (size_t)size);
+    if (fp && fclose(fp) != 0) {
+        ok = false;
+    }
+    free(data);
+
+#ifdef _WIN32
+    if (ok) {
+        remove(filename.c_str());
+    }
+#endif
+    if (!ok || rename(temp_filename.c_str(), filename.c_str()) != 0) {
+        printf("Could not write %s for the glyph atlas cache.\n", filename.c_str());
+        remove(temp_filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+void glyph_atlas_cache_prewarm(const char* font, const std::vector<float>& sizes, const char* charset) {
+    prewarm_requests.push_back({ font, sizes, charset });
+}
@@ -0,0 +1,32 @@
+//
+//  glyph_atlas_cache.hpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#ifndef ddui_glyph_atlas_cache_hpp
+#define ddui_glyph_atlas_cache_hpp
+
+#include <nanovg.h>
+#include <vector>
+
+void glyph_atlas_cache_enable();
+
+// Maps the cache file, if the cache is enabled, for the first frame to
+// load it.
+void glyph_atlas_cache_init();
+void glyph_atlas_cache_terminate();
+
+// Called by the thread that paints at the start of every frame. Loads the
+// cache in the first frame, and puts the glyphs asked for by prewarm into
+// the atlas.
+void glyph_atlas_cache_begin_frame(NVGcontext* vg, float pixel_ratio);
+
+// Returns false if the cache couldn't be written.
+bool glyph_atlas_cache_save(NVGcontext* vg, float pixel_ratio);
+
+void glyph_atlas_cache_prewarm(const char* font, const std::vector<float>& sizes, const char* charset);
+
+#endif
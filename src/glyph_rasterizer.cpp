@@ -0,0 +1,156 @@
+//
+//  glyph_rasterizer.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "glyph_rasterizer.hpp"
+#include "core.hpp"
+#include "profiling.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Glyph jobs go through two queues: the one the workers take them from,
+// and the one they put them in once rasterized, for the thread that paints
+// to finish before each pass. Finishing a job uploads its glyph, so the
+// jobs finished in a frame are limited by a budget of bytes, and the rest
+// wait for the next frame.
+//
+// A worker that rasterizes a glyph while no frame is being painted asks
+// for a repaint. During a frame that's left to the end of the frame, so
+// that glyphs don't add passes to it.
+static void queue_job(void* uptr, FONSglyphJob* job);
+static void run_worker();
+
+// Never destroyed, as the workers are still running at exit
+static std::mutex* mutex;
+static std::condition_variable* job_condition;
+static std::condition_variable* idle_condition;
+static auto& queued_jobs = *new std::deque<FONSglyphJob*>;
+static auto& rasterized_jobs = *new std::deque<FONSglyphJob*>;
+static int num_workers;
+static int num_busy_workers;
+static bool is_frame_open;
+
+static int upload_budget = 256 * 1024;
+static int frame_upload_bytes;
+
+void glyph_rasterizer_set_enabled(NVGcontext* vg, bool enabled) {
+    if (!enabled) {
+        nvgInternalGlyphJobCallback(vg, NULL, NULL);
+        return;
+    }
+
+    if (num_workers == 0) {
+        mutex = new std::mutex;
+        job_condition = new std::condition_variable;
+        idle_condition = new std::condition_variable;
+        num_workers = std::max(1, std::min((int)std::thread::hardware_concurrency() - 1, 4));
+        for (int i = 0; i < num_workers; ++i) {
+            std::thread(run_worker).detach();
+        }
+    }
+    nvgInternalGlyphJobCallback(vg, queue_job, NULL);
+}
+
+void glyph_rasterizer_set_upload_budget(int bytes) {
+    upload_budget = bytes;
+}
+
+void queue_job(void* uptr, FONSglyphJob* job) {
+    std::unique_lock<std::mutex> lock(*mutex);
+    queued_jobs.push_back(job);
+    job_condition->notify_one();
+}
+
+void run_worker() {
+    std::unique_lock<std::mutex> lock(*mutex);
+    while (true) {
+        if (queued_jobs.empty()) {
+            job_condition->wait(lock);
+            continue;
+        }
+
+        auto job = queued_jobs.front();
+        queued_jobs.pop_front();
+        num_busy_workers += 1;
+        lock.unlock();
+
+        {
+            DDUI_PROFILE_SCOPE("rasterize glyph");
+            nvgInternalRasterizeGlyphJob(job);
+        }
+
+        lock.lock();
+        num_busy_workers -= 1;
+        auto should_repaint = rasterized_jobs.empty() && !is_frame_open;
+        rasterized_jobs.push_back(job);
+        if (queued_jobs.empty() && num_busy_workers == 0) {
+            idle_condition->notify_all();
+        }
+
+        if (should_repaint) {
+            lock.unlock();
+            ddui::repaint("glyph_rasterizer");
+            lock.lock();
+        }
+    }
+}
+
+void glyph_rasterizer_begin_frame() {
+    frame_upload_bytes = 0;
+    if (num_workers == 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(*mutex);
+    is_frame_open = true;
+}
+
+void glyph_rasterizer_finish_jobs(NVGcontext* vg) {
+    if (num_workers == 0) {
+        return;
+    }
+
+    // At least one glyph a frame, however big
+    std::unique_lock<std::mutex> lock(*mutex);
+    while (!rasterized_jobs.empty()) {
+        auto job = rasterized_jobs.front();
+        auto size = nvgInternalGlyphJobSize(job);
+        if (frame_upload_bytes > 0 && frame_upload_bytes + size > upload_budget) {
+            break;
+        }
+        rasterized_jobs.pop_front();
+        frame_upload_bytes += size;
+        nvgInternalFinishGlyphJob(vg, job);
+    }
+}
+
+bool glyph_rasterizer_end_frame() {
+    if (num_workers == 0) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(*mutex);
+    is_frame_open = false;
+    return !rasterized_jobs.empty();
+}
+
+void glyph_rasterizer_terminate(NVGcontext* vg) {
+    if (num_workers == 0) {
+        return;
+    }
+    nvgInternalGlyphJobCallback(vg, NULL, NULL);
+
+    std::unique_lock<std::mutex> lock(*mutex);
+    while (!queued_jobs.empty() || num_busy_workers > 0) {
+        idle_condition->wait(lock);
+    }
+    while (!rasterized_jobs.empty()) {
+        nvgInternalFinishGlyphJob(vg, rasterized_jobs.front());
+        rasterized_jobs.pop_front();
+    }
+}
@@ -0,0 +1,30 @@
+//
+//  glyph_rasterizer.hpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#ifndef ddui_glyph_rasterizer_hpp
+#define ddui_glyph_rasterizer_hpp
+
+#include <nanovg.h>
+
+// Hands the glyph jobs of vg to worker threads, or stops handing them out.
+// Jobs that are already out still come back.
+void glyph_rasterizer_set_enabled(NVGcontext* vg, bool enabled);
+void glyph_rasterizer_set_upload_budget(int bytes);
+
+// Called by the thread that paints: at the start of a frame, before each
+// pass, to put rasterized glyphs into the atlas within the budget of the
+// frame, and at the end of a frame. Returns true if glyphs are waiting.
+void glyph_rasterizer_begin_frame();
+void glyph_rasterizer_finish_jobs(NVGcontext* vg);
+bool glyph_rasterizer_end_frame();
+
+// Waits for every job that is out, and finishes them, so that vg can be
+// deleted.
+void glyph_rasterizer_terminate(NVGcontext* vg);
+
+#endif
@@ -19,3 +19,20 @@ NVGcontext* nvgCreate(void* device) {
 void nvgDelete(NVGcontext* vg) {
     nvgDeleteD3D11(vg);
 }
+
+bool nvgBindPersistentFramebuffer(NVGcontext* vg, int width, int height) {
+    // The swap chain doesn't keep the previous frame, so every frame
+    // is drawn in full
+    return false;
+}
+
+void nvgClearFramebuffer(NVGcontext* vg, int x, int y, int width, int height, NVGcolor color) {
+    // The whole render target is cleared when the frame is set up
+}
+
+bool nvgPresentPersistentFramebuffer(NVGcontext* vg, int width, int height) {
+    return true;
+}
+
+void nvgBindPersistentReadFramebuffer(NVGcontext* vg) {
+}
@@ -12,11 +12,66 @@
 
 #define NANOVG_GL3_IMPLEMENTATION
 #include <nanovg_gl.h>
+#include <nanovg_gl_utils.h>
+
+// Frames are drawn into an offscreen framebuffer that is blitted to the
+// window, because the contents of the back buffer are undefined after a
+// swap and a partial redraw needs the previous frame to draw over.
+static NVGLUframebuffer* persistent_framebuffer;
+static int persistent_framebuffer_width, persistent_framebuffer_height;
 
 NVGcontext* nvgCreate(void* device) {
-    return nvgCreateGL3(NVG_ANTIALIAS | NVG_STENCIL_STROKES | NVG_DEBUG);
+    return nvgCreateGL3(NVG_ANTIALIAS | NVG_STENCIL_STROKES | NVG_DEBUG | NVG_SKIP_UNCHANGED_FRAMES);
 }
 
 void nvgDelete(NVGcontext* vg) {
+    if (persistent_framebuffer) {
+        nvgluDeleteFramebuffer(persistent_framebuffer);
+        persistent_framebuffer = NULL;
+    }
     nvgDeleteGL3(vg);
 }
+
+bool nvgBindPersistentFramebuffer(NVGcontext* vg, int width, int height) {
+    bool preserved = true;
+    if (!persistent_framebuffer ||
+        persistent_framebuffer_width != width ||
+        persistent_framebuffer_height != height) {
+        if (persistent_framebuffer) {
+            nvgluDeleteFramebuffer(persistent_framebuffer);
+        }
+        persistent_framebuffer = nvgluCreateFramebuffer(vg, width, height, 0);
+        persistent_framebuffer_width = width;
+        persistent_framebuffer_height = height;
+        preserved = false;
+    }
+    if (!persistent_framebuffer) {
+        nvgluBindFramebuffer(NULL);
+        return false;
+    }
+    nvgluBindFramebuffer(persistent_framebuffer);
+    return preserved;
+}
+
+void nvgClearFramebuffer(NVGcontext* vg, int x, int y, int width, int height, NVGcolor color) {
+    // GL counts rows from the bottom
+    nvglClearRectGL3(vg, x, persistent_framebuffer_height - y - height, width, height, color);
+}
+
+bool nvgPresentPersistentFramebuffer(NVGcontext* vg, int width, int height) {
+    if (nvglFrameSkippedGL3(vg)) {
+        return false;
+    }
+    if (!persistent_framebuffer) {
+        return true;
+    }
+    nvgluBindFramebuffer(NULL);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, persistent_framebuffer->fbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    nvgluBindFramebuffer(NULL);
+    return true;
+}
+
+void nvgBindPersistentReadFramebuffer(NVGcontext* vg) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, persistent_framebuffer ? persistent_framebuffer->fbo : 0);
+}
@@ -14,4 +14,25 @@
 NVGcontext* nvgCreate(void* device = nullptr);
 void nvgDelete(NVGcontext*);
 
+// Binds the framebuffer that frames are drawn into. Its contents are kept
+// from one frame to the next, which is what allows a frame to redraw only
+// part of the window. Returns false if the contents of the previous frame
+// were lost, e.g. because the size changed, in which case the frame has to
+// be drawn in full.
+bool nvgBindPersistentFramebuffer(NVGcontext* vg, int width, int height);
+
+// Clears a rectangle of the framebuffer, in pixels with the origin at the
+// top-left corner. The clear happens before the draw calls of the frame
+// are flushed, so it can be called any time before nvgEndFrame().
+void nvgClearFramebuffer(NVGcontext* vg, int x, int y, int width, int height, NVGcolor color);
+
+// Copies the framebuffer to the window, if it isn't drawn into directly.
+// Returns false if the backend found the frame to be identical to the
+// previous one and skipped it, in which case there is nothing to present.
+bool nvgPresentPersistentFramebuffer(NVGcontext* vg, int width, int height);
+
+// Binds the framebuffer that frames are drawn into for reading, so that
+// the last frame can be read back after it was presented.
+void nvgBindPersistentReadFramebuffer(NVGcontext* vg);
+
 #endif
@@ -0,0 +1,220 @@
+//
+//  init.null.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "init.hpp"
+#include <vector>
+#include <string.h>
+
+// The null backend implements the nanovg render callbacks without
+// touching any graphics API. Everything up to the backend (update(),
+// nvgBeginFrame, path tessellation, fontstash layout) runs as usual,
+// and the backend does the CPU-side work the GL backends do (copying
+// vertices into a per-frame buffer) before throwing the frame away.
+// This lets us measure the CPU cost of a frame on machines without a GPU.
+//
+// Render stats are counted the way the GL3 backend counts them, so that
+// budgets checked on a headless machine hold on a real one.
+
+namespace {
+
+struct NullTexture {
+    int id;
+    int type;
+    int width, height;
+    int flags;
+};
+
+// The GL3 backend uploads a uniform block of 11 vec4s per call (before it
+// is padded to the GPU's alignment), and two for stencil fills and strokes
+const int FRAG_UNIFORM_SIZE = 11 * 4 * sizeof(float);
+
+struct NullContext {
+    std::vector<NullTexture> textures;
+    int next_texture_id;
+    std::vector<NVGvertex> verts;
+
+    // Counted per call, and added to the stats on flush
+    NVGrenderStats frame_stats;
+    NVGrenderStats stats;
+};
+
+int bytes_per_pixel(int type) {
+    return type == NVG_TEXTURE_RGBA ? 4 : 1;
+}
+
+NullTexture* find_texture(NullContext* ctx, int id) {
+    for (auto& texture : ctx->textures) {
+        if (texture.id == id) {
+            return &texture;
+        }
+    }
+    return NULL;
+}
+
+void copy_paths(NullContext* ctx, const NVGpath* paths, int npaths) {
+    for (int i = 0; i < npaths; ++i) {
+        const auto& path = paths[i];
+        ctx->verts.insert(ctx->verts.end(), path.fill, path.fill + path.nfill);
+        ctx->verts.insert(ctx->verts.end(), path.stroke, path.stroke + path.nstroke);
+    }
+}
+
+int render_create(void* uptr) {
+    return 1;
+}
+
+int render_create_texture(void* uptr, int type, int w, int h, int image_flags, const unsigned char* data) {
+    auto ctx = (NullContext*)uptr;
+
+    NullTexture texture;
+    texture.id = ++ctx->next_texture_id;
+    texture.type = type;
+    texture.width = w;
+    texture.height = h;
+    texture.flags = image_flags;
+    ctx->textures.push_back(texture);
+
+    if (data) {
+        ctx->stats.textureBytes += w * h * bytes_per_pixel(type);
+    }
+
+    return texture.id;
+}
+
+int render_delete_texture(void* uptr, int image) {
+    auto ctx = (NullContext*)uptr;
+    for (int i = 0; i < ctx->textures.size(); ++i) {
+        if (ctx->textures[i].id == image) {
+            ctx->textures.erase(ctx->textures.begin() + i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int render_update_texture(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data) {
+    auto ctx = (NullContext*)uptr;
+    auto texture = find_texture(ctx, image);
+    if (texture == NULL) {
+        return 0;
+    }
+    ctx->stats.textureBytes += w * h * bytes_per_pixel(texture->type);
+    return 1;
+}
+
+int render_get_texture_size(void* uptr, int image, int* w, int* h) {
+    auto ctx = (NullContext*)uptr;
+    auto texture = find_texture(ctx, image);
+    if (texture == NULL) {
+        return 0;
+    }
+    *w = texture->width;
+    *h = texture->height;
+    return 1;
+}
+
+void render_viewport(void* uptr, float width, float height, float device_pixel_ratio) {
+}
+
+void render_cancel(void* uptr) {
+    auto ctx = (NullContext*)uptr;
+    ctx->verts.clear();
+    memset(&ctx->frame_stats, 0, sizeof(ctx->frame_stats));
+}
+
+void render_flush(void* uptr) {
+    auto ctx = (NullContext*)uptr;
+    auto& frame_stats = ctx->frame_stats;
+    ctx->stats.calls += frame_stats.calls;
+    ctx->stats.vertices += (int)ctx->verts.size();
+    ctx->stats.uniformBytes += frame_stats.uniformBytes;
+    ctx->stats.convexFills += frame_stats.convexFills;
+    ctx->stats.stencilFills += frame_stats.stencilFills;
+    ctx->verts.clear();
+    memset(&frame_stats, 0, sizeof(frame_stats));
+}
+
+void render_fill(void* uptr, NVGpaint* paint, NVGcompositeOperationState composite_operation, NVGscissor* scissor, float fringe, const float* bounds, const NVGpath* paths, int npaths) {
+    auto ctx = (NullContext*)uptr;
+    copy_paths(ctx, paths, npaths);
+
+    // Fills other than a single convex path also draw a bounding quad
+    auto& frame_stats = ctx->frame_stats;
+    frame_stats.calls += 1;
+    if (npaths == 1 && paths[0].convex) {
+        frame_stats.convexFills += 1;
+        frame_stats.uniformBytes += FRAG_UNIFORM_SIZE;
+    } else {
+        frame_stats.stencilFills += 1;
+        frame_stats.uniformBytes += 2 * FRAG_UNIFORM_SIZE;
+        ctx->verts.resize(ctx->verts.size() + 4);
+    }
+}
+
+void render_stroke(void* uptr, NVGpaint* paint, NVGcompositeOperationState composite_operation, NVGscissor* scissor, float fringe, float stroke_width, const NVGpath* paths, int npaths) {
+    auto ctx = (NullContext*)uptr;
+    copy_paths(ctx, paths, npaths);
+    ctx->frame_stats.calls += 1;
+    ctx->frame_stats.uniformBytes += 2 * FRAG_UNIFORM_SIZE;
+}
+
+void render_triangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState composite_operation, NVGscissor* scissor, const NVGvertex* verts, int nverts, float fringe) {
+    auto ctx = (NullContext*)uptr;
+    ctx->verts.insert(ctx->verts.end(), verts, verts + nverts);
+    ctx->frame_stats.calls += 1;
+    ctx->frame_stats.uniformBytes += FRAG_UNIFORM_SIZE;
+}
+
+void render_delete(void* uptr) {
+    delete (NullContext*)uptr;
+}
+
+}
+
+NVGcontext* nvgCreate(void* device) {
+    NVGparams params;
+    memset(&params, 0, sizeof(params));
+    params.renderCreate = render_create;
+    params.renderCreateTexture = render_create_texture;
+    params.renderDeleteTexture = render_delete_texture;
+    params.renderUpdateTexture = render_update_texture;
+    params.renderGetTextureSize = render_get_texture_size;
+    params.renderViewport = render_viewport;
+    params.renderCancel = render_cancel;
+    params.renderFlush = render_flush;
+    params.renderFill = render_fill;
+    params.renderStroke = render_stroke;
+    params.renderTriangles = render_triangles;
+    params.renderDelete = render_delete;
+    auto ctx = new NullContext();
+    params.userPtr = ctx;
+    params.edgeAntiAlias = 1;
+    params.renderStats = &ctx->stats;
+
+    // The context is freed through render_delete, even on failure
+    return nvgCreateInternal(&params);
+}
+
+void nvgDelete(NVGcontext* vg) {
+    nvgDeleteInternal(vg);
+}
+
+bool nvgBindPersistentFramebuffer(NVGcontext* vg, int width, int height) {
+    // There are no pixels to lose
+    return true;
+}
+
+void nvgClearFramebuffer(NVGcontext* vg, int x, int y, int width, int height, NVGcolor color) {
+}
+
+bool nvgPresentPersistentFramebuffer(NVGcontext* vg, int width, int height) {
+    return true;
+}
+
+void nvgBindPersistentReadFramebuffer(NVGcontext* vg) {
+}
@@ -0,0 +1,46 @@
+//
+//  init.software.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "init.hpp"
+
+#define NANOVG_SW_IMPLEMENTATION
+#include <nanovg_sw.h>
+
+// The software backend rasterizes frames on the CPU into an RGBA buffer,
+// which can be read back with read_framebuffer(). It needs no GPU or
+// window, so it is meant for golden-image tests and for measuring the
+// raster cost of views on machines without a GPU.
+
+NVGcontext* nvgCreate(void* device) {
+    return nvgCreateSW(NVGSW_ANTIALIAS | NVGSW_STENCIL_STROKES);
+}
+
+void nvgDelete(NVGcontext* vg) {
+    nvgDeleteSW(vg);
+}
+
+bool nvgBindPersistentFramebuffer(NVGcontext* vg, int width, int height) {
+    int current_width, current_height;
+    if (nvgswFramebuffer(vg, &current_width, &current_height) != NULL &&
+        current_width == width && current_height == height) {
+        return true;
+    }
+    nvgswClear(vg, width, height, nvgRGBAf(0.0f, 0.0f, 0.0f, 0.0f));
+    return false;
+}
+
+void nvgClearFramebuffer(NVGcontext* vg, int x, int y, int width, int height, NVGcolor color) {
+    nvgswClearRect(vg, x, y, width, height, color);
+}
+
+bool nvgPresentPersistentFramebuffer(NVGcontext* vg, int width, int height) {
+    return true;
+}
+
+void nvgBindPersistentReadFramebuffer(NVGcontext* vg) {
+}
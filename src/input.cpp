@@ -348,4 +348,18 @@ bool has_input_events_to_process() {
     return !input_events_queue.empty();
 }
 
+bool has_only_mouse_position_events(int* x, int* y) {
+    if (input_events_queue.empty()) {
+        return false;
+    }
+    for (const auto& event : input_events_queue) {
+        if (event.type != InputEvent::MOUSE_POSITION) {
+            return false;
+        }
+    }
+    *x = input_events_queue.back().x;
+    *y = input_events_queue.back().y;
+    return true;
+}
+
 }
@@ -8,6 +8,8 @@
 
 #include "Drawing.hpp"
 #include "Measurements.hpp"
+#include <ddui/util/caret_flicker>
+#include <ddui/profiling>
 #include <cstdlib>
 #include <cstring>
 
@@ -19,6 +21,7 @@ void draw_content(float offset_x, float offset_y,
                   const Model* model,
                   const Measurements* measurements,
                   const DrawEntityFn& draw_entity) {
+    DDUI_PROFILE_SCOPE("TextEdit::draw_content");
 
     float y = offset_y;
     for (int lineno = 0; lineno < model->lines.size(); ++lineno) {
@@ -107,6 +110,8 @@ void draw_selection(float offset_x, float offset_y,
         move_to(x, line.y);
         line_to(x, line.y + line.height);
         stroke();
+
+        caret_flicker::set_caret_rect(x - 1.0, line.y, 2.0, line.height);
         
     } else {
         // Selection
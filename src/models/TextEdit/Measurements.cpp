@@ -7,12 +7,14 @@
 //
 
 #include "Measurements.hpp"
+#include <ddui/profiling>
 
 namespace TextEdit {
 
 using namespace ddui;
 
 Measurements measure(const Model* model, const MeasureEntityFn& measure_entity) {
+    DDUI_PROFILE_SCOPE("TextEdit::measure");
 
     text_align(align::LEFT | align::BASELINE);
 
@@ -9,102 +9,328 @@
 #include "profiling.hpp"
 #include "core.hpp"
 #include <ddui/util/get_content_filename>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <sstream>
-#include <iomanip>
 
 namespace profiling {
 
-static void write_to_buffer(std::string data);
-static void add_profiling_entry(std::time_t start_time, bool is_animating, int num_set_immediates, int num_repaints, int duration);
-
 int num_set_immediates = 0;
 int num_repaints = 0;
+int num_skipped_frames = 0;
+int num_timer_frames_saved = 0;
+
+// Single-producer, single-consumer ring of events. The thread that owns
+// it is the only one to write, and the exporter the only one to read.
+// When the exporter falls behind, new events are dropped.
+struct EventRing {
+    static const uint32_t CAPACITY = 1 << 15;
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> num_dropped;
+    uint32_t thread_id;
+    Event events[CAPACITY];
+};
+
+static const uint16_t FLAG_ANIMATING = 1 << 0;
+static const uint32_t ZONE_END_RESERVE = 256;
+
+// Names are interned through a small cache of each thread's own, and the
+// shared table is only locked when a name isn't in it. The cache is keyed
+// by pointer, and a pointer can be a buffer that is reused for other
+// names, so a cached id is only used if its text still matches. Names are
+// kept in a deque, which leaves them where they are as it grows.
+//
+// The tables and locks that the exporter thread uses are never destroyed,
+// as it is still running at exit.
+static auto& names_mutex = *new std::mutex;
+static auto& names = *new std::deque<std::string>;
+static auto& name_ids = *new std::unordered_map<std::string, uint32_t>;
+
+struct CachedName {
+    const char* pointer;
+    const std::string* name;
+    uint32_t id;
+};
+static const int NAME_CACHE_SIZE = 64;
+static thread_local CachedName name_cache[NAME_CACHE_SIZE];
 
-static std::chrono::high_resolution_clock::time_point time_a, time_b;
-static std::time_t start_time;
-static std::mutex repaint_reasons_mutex;
-static std::stringstream repaint_reasons;
-static bool repaint_reasons_empty;
+static auto& rings_mutex = *new std::mutex;
+static auto& rings = *new std::vector<EventRing*>;
+static thread_local EventRing* thread_ring;
+
+static auto& export_mutex = *new std::mutex;
+static auto& export_condition = *new std::condition_variable;
+static FILE* export_file;
+static auto& exported_thread_ids = *new std::vector<uint32_t>;
+
+static uint32_t frame_name_id, pass_name_id;
+
+static EventRing* get_thread_ring();
+static void start_exporter();
+static void export_thread();
+static void export_events(std::string& out);
+
+static uint64_t get_time() {
+    static auto epoch = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch
+    ).count();
+}
 
 void frame_start() {
-    time_a = std::chrono::high_resolution_clock::now();
-    start_time = std::time(nullptr);
+    static bool exporter_started = false;
+    if (!exporter_started) {
+        exporter_started = true;
+        frame_name_id = intern_name("frame");
+        pass_name_id = intern_name("repaint pass");
+        start_exporter();
+    }
+
     num_set_immediates = 0;
     num_repaints = 0;
-    repaint_reasons_mutex.lock();
-    repaint_reasons = std::stringstream();
-    repaint_reasons_empty = true;
-    repaint_reasons_mutex.unlock();
+    num_skipped_frames = 0;
+    num_timer_frames_saved = 0;
+    record_event(EVENT_FRAME_START, frame_name_id);
 }
 
 void frame_end() {
-    time_b = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(time_b - time_a).count();
-    add_profiling_entry(start_time, ddui::animation::is_animating(), num_set_immediates, num_repaints, (int)(duration * 1000000.0));
+    uint16_t flags = ddui::animation::is_animating() ? FLAG_ANIMATING : 0;
+    record_event(EVENT_FRAME_END, frame_name_id, flags,
+                 num_set_immediates, num_repaints, num_skipped_frames, num_timer_frames_saved);
 }
 
 void repaint_start() {
-    repaint_reasons_mutex.lock();
-    if (!repaint_reasons_empty) {
-        repaint_reasons << '|';
-        repaint_reasons_empty = true;
-    }
-    repaint_reasons_mutex.unlock();
+    record_event(EVENT_REPAINT_PASS, pass_name_id, 0, num_repaints);
 }
 
 void repaint_reason(const char* reason) {
-    repaint_reasons_mutex.lock();
-    if (num_repaints == 0) {
-        repaint_reasons_mutex.unlock();
-        return;
+    record_event(EVENT_REPAINT_REASON, intern_name(reason));
+}
+
+uint32_t intern_name(const char* name) {
+    auto slot = ((uint64_t)(uintptr_t)name * 0x9E3779B97F4A7C15ull >> 32) % NAME_CACHE_SIZE;
+    auto& cached = name_cache[slot];
+    if (cached.pointer == name && strcmp(cached.name->c_str(), name) == 0) {
+        return cached.id;
+    }
+
+    std::lock_guard<std::mutex> lock(names_mutex);
+    uint32_t id;
+    auto it_shared = name_ids.find(name);
+    if (it_shared != name_ids.end()) {
+        id = it_shared->second;
+    } else {
+        id = (uint32_t)names.size();
+        names.push_back(name);
+        name_ids[name] = id;
+    }
+    cached.pointer = name;
+    cached.name = &names[id];
+    cached.id = id;
+    return id;
+}
+
+bool record_event(EventType type, uint32_t name_id, uint16_t flags,
+                  int32_t arg0, int32_t arg1, int32_t arg2, int32_t arg3) {
+    auto ring = get_thread_ring();
+    auto head = ring->head.load(std::memory_order_relaxed);
+    auto tail = ring->tail.load(std::memory_order_acquire);
+
+    // Zones only begin if there's room left for them to end
+    auto capacity = EventRing::CAPACITY;
+    if (type == EVENT_ZONE_BEGIN) {
+        capacity -= ZONE_END_RESERVE;
     }
-    if (!repaint_reasons_empty) {
-        repaint_reasons << '&';
+    if (head - tail >= capacity) {
+        ring->num_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
-    repaint_reasons << reason;
-    repaint_reasons_empty = false;
-    repaint_reasons_mutex.unlock();
+
+    auto& event = ring->events[head & (EventRing::CAPACITY - 1)];
+    event.time = get_time();
+    event.type = type;
+    event.flags = flags;
+    event.name_id = name_id;
+    event.args[0] = arg0;
+    event.args[1] = arg1;
+    event.args[2] = arg2;
+    event.args[3] = arg3;
+    ring->head.store(head + 1, std::memory_order_release);
+    return true;
 }
 
-void add_profiling_entry(std::time_t start_time, bool is_animating, int num_set_immediates, int num_repaints, int duration) {
-    std::stringstream ss; 
-    ss << std::put_time(std::gmtime(&start_time), "%FT%T") << ',';
-    ss << (is_animating ? '1' : '0') << ',';
-    ss << num_set_immediates << ',';
-    ss << num_repaints << ',';
-    ss << duration << ',';
-    repaint_reasons_mutex.lock();
-    ss << repaint_reasons.str() << '\n';
-    repaint_reasons_mutex.unlock();
-    write_to_buffer(ss.str());
+EventRing* get_thread_ring() {
+    if (!thread_ring) {
+        auto ring = new EventRing();
+        ring->head = 0;
+        ring->tail = 0;
+        ring->num_dropped = 0;
+
+        // Rings are never freed, so events of threads that
+        // have exited can still be exported
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        ring->thread_id = (uint32_t)rings.size() + 1;
+        rings.push_back(ring);
+        thread_ring = ring;
+    }
+    return thread_ring;
 }
 
-void write_to_buffer(std::string data) {
+void start_exporter() {
+    auto filename = get_content_filename("profiling_trace.json");
+    export_file = fopen(filename.c_str(), "w");
+    if (!export_file) {
+        printf("Could not open %s for the profiling trace.\n", filename.c_str());
+        return;
+    }
 
-    static FILE* file_handle = NULL;
-    
-    // Open file
-    if (file_handle == NULL) {
-        auto filename = get_content_filename("profiling_data_2.csv");
-        file_handle = fopen(filename.c_str(), "a");
+    // The closing bracket of the JSON array format is
+    // optional, which lets us stream the events out
+    fputs("[\n", export_file);
+    std::thread(export_thread).detach();
+    atexit(flush);
+}
+
+void export_thread() {
+    std::string out;
+    std::unique_lock<std::mutex> lock(export_mutex);
+    while (true) {
+        export_condition.wait_for(lock, std::chrono::milliseconds(500));
+        out.clear();
+        export_events(out);
+        fwrite(out.data(), 1, out.size(), export_file);
+        fflush(export_file);
     }
+}
 
-    // Write data
-    fwrite(data.c_str(), 1, data.size(), file_handle);
+void flush() {
+    if (!export_file) {
+        return;
+    }
+    std::string out;
+    std::lock_guard<std::mutex> lock(export_mutex);
+    export_events(out);
+    fwrite(out.data(), 1, out.size(), export_file);
+    fflush(export_file);
+}
 
-    // Flush file
-    static auto buffer_last_flushed = std::chrono::high_resolution_clock::now();
-    auto current_time = std::chrono::high_resolution_clock::now();
-    auto seconds_since_last_flush = (int)std::chrono::duration_cast<std::chrono::duration<double>>(
-        current_time - buffer_last_flushed
-    ).count();
-    if (seconds_since_last_flush > 30) {
-        fflush(file_handle);
+static void append_escaped(std::string& out, const std::string& text) {
+    for (auto c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        } else {
+            out += c;
+        }
     }
+}
 
+// Expects export_mutex to be locked
+void export_events(std::string& out) {
+    std::vector<EventRing*> rings_to_export;
+    rings_mutex.lock();
+    rings_to_export = rings;
+    rings_mutex.unlock();
+
+    // Copy of the name table, taken once, and only if it is needed
+    std::vector<std::string> names_to_export;
+    auto get_name = [&](uint32_t id) -> const std::string& {
+        if (id >= names_to_export.size()) {
+            std::lock_guard<std::mutex> lock(names_mutex);
+            names_to_export.assign(names.begin(), names.end());
+        }
+        return names_to_export[id];
+    };
+
+    char buffer[256];
+    for (auto ring : rings_to_export) {
+        auto tid = ring->thread_id;
+        if (std::find(exported_thread_ids.begin(), exported_thread_ids.end(), tid) == exported_thread_ids.end()) {
+            exported_thread_ids.push_back(tid);
+            snprintf(buffer, sizeof(buffer),
+                     "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}},\n",
+                     tid, tid == 1 ? "ddui" : "thread", tid);
+            out += buffer;
+        }
+
+        auto tail = ring->tail.load(std::memory_order_relaxed);
+        auto head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const auto& event = ring->events[tail & (EventRing::CAPACITY - 1)];
+            auto ts = event.time / 1000.0;
+            switch (event.type) {
+                case EVENT_FRAME_START:
+                    snprintf(buffer, sizeof(buffer),
+                             "{\"name\":\"frame\",\"cat\":\"ddui\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":%u},\n",
+                             ts, tid);
+                    out += buffer;
+                    break;
+                case EVENT_FRAME_END:
+                    snprintf(buffer, sizeof(buffer),
+                             "{\"name\":\"frame\",\"cat\":\"ddui\",\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+                             "\"args\":{\"animating\":%d,\"set_immediates\":%d,\"passes\":%d,"
+                             "\"skipped\":%d,\"timer_frames_saved\":%d}},\n",
+                             ts, tid, (event.flags & FLAG_ANIMATING) ? 1 : 0,
+                             event.args[0], event.args[1], event.args[2], event.args[3]);
+                    out += buffer;
+                    snprintf(buffer, sizeof(buffer),
+                             "{\"name\":\"frame stats\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+                             "\"args\":{\"set_immediates\":%d,\"passes\":%d}},\n",
+                             ts, tid, event.args[0], event.args[1]);
+                    out += buffer;
+                    break;
+                case EVENT_REPAINT_PASS:
+                    snprintf(buffer, sizeof(buffer),
+                             "{\"name\":\"repaint pass\",\"cat\":\"ddui\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+                             "\"args\":{\"pass\":%d}},\n",
+                             ts, tid, event.args[0]);
+                    out += buffer;
+                    break;
+                case EVENT_ZONE_BEGIN:
+                case EVENT_ZONE_END:
+                    out += "{\"name\":\"";
+                    append_escaped(out, get_name(event.name_id));
+                    snprintf(buffer, sizeof(buffer),
+                             "\",\"cat\":\"zone\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u},\n",
+                             event.type == EVENT_ZONE_BEGIN ? "B" : "E", ts, tid);
+                    out += buffer;
+                    break;
+                case EVENT_REPAINT_REASON:
+                    out += "{\"name\":\"";
+                    append_escaped(out, get_name(event.name_id));
+                    snprintf(buffer, sizeof(buffer),
+                             "\",\"cat\":\"repaint\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u},\n",
+                             ts, tid);
+                    out += buffer;
+                    break;
+            }
+        }
+        ring->tail.store(tail, std::memory_order_release);
+
+        auto num_dropped = ring->num_dropped.exchange(0, std::memory_order_relaxed);
+        if (num_dropped > 0) {
+            snprintf(buffer, sizeof(buffer),
+                     "{\"name\":\"dropped events\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+                     "\"args\":{\"count\":%u}},\n",
+                     get_time() / 1000.0, tid, num_dropped);
+            out += buffer;
+        }
+    }
 }
 
 }
@@ -9,8 +9,24 @@
 #ifndef ddui_profiling_hpp
 #define ddui_profiling_hpp
 
-#include <ctime>
-#include <chrono>
+#include <stdint.h>
+
+// Profiling records fixed-size events into a lock-free ring buffer per
+// thread. A background thread drains the buffers and writes them out as
+// Chrome trace-event JSON (profiling_trace.json in the content directory),
+// which can be opened in Perfetto or chrome://tracing.
+//
+// All calls into profiling are made under #ifdef DDUI_PROFILING_ON, so
+// none of this costs anything when profiling isn't compiled in.
+//
+// Code can mark out its own zones with DDUI_PROFILE_SCOPE, which records
+// a begin event where it's placed and an end event when the enclosing
+// scope exits. Zones nest, and show up as slices in the trace:
+//
+//     void update() {
+//         DDUI_PROFILE_SCOPE("MyView::update");
+//         ...
+//     }
 
 namespace profiling {
 
@@ -20,7 +36,64 @@ void repaint_start();
 void repaint_reason(const char* reason);
 extern int num_set_immediates;
 extern int num_repaints;
+extern int num_skipped_frames;
+extern int num_timer_frames_saved;
+
+enum EventType : uint16_t {
+    EVENT_FRAME_START,
+    EVENT_FRAME_END,
+    EVENT_REPAINT_PASS,
+    EVENT_REPAINT_REASON,
+    EVENT_ZONE_BEGIN,
+    EVENT_ZONE_END
+};
+
+struct Event {
+    uint64_t time; // nanoseconds
+    uint16_t type;
+    uint16_t flags;
+    uint32_t name_id;
+    int32_t args[4];
+};
+
+// Returns a stable id for the name, copying it on first sight
+uint32_t intern_name(const char* name);
+
+// Returns false if the event was dropped because the ring was full
+bool record_event(EventType type, uint32_t name_id, uint16_t flags = 0,
+                  int32_t arg0 = 0, int32_t arg1 = 0, int32_t arg2 = 0, int32_t arg3 = 0);
+
+// Writes out everything that has been recorded so far
+void flush();
+
+struct Zone {
+    uint32_t name_id;
+    bool recorded;
+
+    Zone(uint32_t name_id) : name_id(name_id) {
+        recorded = record_event(EVENT_ZONE_BEGIN, name_id);
+    }
+    ~Zone() {
+        // Without its begin event the end event would close the parent zone
+        if (recorded) {
+            record_event(EVENT_ZONE_END, name_id);
+        }
+    }
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+};
 
 }
 
+#define DDUI_PROFILE_CONCAT_(a, b) a##b
+#define DDUI_PROFILE_CONCAT(a, b) DDUI_PROFILE_CONCAT_(a, b)
+
+#ifdef DDUI_PROFILING_ON
+#define DDUI_PROFILE_SCOPE(name) \
+    static const uint32_t DDUI_PROFILE_CONCAT(ddui_profile_zone_id_, __LINE__) = ::profiling::intern_name(name); \
+    ::profiling::Zone DDUI_PROFILE_CONCAT(ddui_profile_zone_, __LINE__)(DDUI_PROFILE_CONCAT(ddui_profile_zone_id_, __LINE__))
+#else
+#define DDUI_PROFILE_SCOPE(name) do {} while (0)
+#endif
+
 #endif
@@ -0,0 +1,276 @@
+//
+//  render_recorder.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "render_recorder.hpp"
+#include <math.h>
+#include <string.h>
+
+struct RecorderFrame {
+    RenderRecording* recording;
+    float origin_x, origin_y;
+    NVGscissor clip;
+};
+
+static NVGcontext* context;
+static NVGparams backend;
+static NVGscissor root_clip = { { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }, { -1.0f, -1.0f } };
+static std::vector<RecorderFrame> frames;
+static std::vector<NVGpath> replay_paths;
+static std::vector<NVGvertex> replay_verts;
+
+void RenderRecording::clear() {
+    calls.clear();
+    paths.clear();
+    verts.clear();
+}
+
+static void scissor_bounds(const NVGscissor* scissor, float* bounds) {
+    auto& xform = scissor->xform;
+    auto half_width  = fabsf(xform[0]) * scissor->extent[0] + fabsf(xform[2]) * scissor->extent[1];
+    auto half_height = fabsf(xform[1]) * scissor->extent[0] + fabsf(xform[3]) * scissor->extent[1];
+    bounds[0] = xform[4] - half_width;
+    bounds[1] = xform[5] - half_height;
+    bounds[2] = xform[4] + half_width;
+    bounds[3] = xform[5] + half_height;
+}
+
+// Intersects the clip into the scissor, using the bounding boxes of both
+// like nvgIntersectScissor() does. Returns false if nothing is left.
+static bool intersect_scissor(NVGscissor* scissor, const NVGscissor* clip) {
+    if (clip->extent[0] < 0) {
+        return true;
+    }
+    if (scissor->extent[0] < 0) {
+        *scissor = *clip;
+        return clip->extent[0] > 0 && clip->extent[1] > 0;
+    }
+
+    float a[4], b[4];
+    scissor_bounds(scissor, a);
+    scissor_bounds(clip, b);
+
+    auto x0 = a[0] > b[0] ? a[0] : b[0];
+    auto y0 = a[1] > b[1] ? a[1] : b[1];
+    auto x1 = a[2] < b[2] ? a[2] : b[2];
+    auto y1 = a[3] < b[3] ? a[3] : b[3];
+    if (x1 <= x0 || y1 <= y0) {
+        return false;
+    }
+
+    nvgTransformIdentity(scissor->xform);
+    scissor->xform[4] = (x0 + x1) * 0.5f;
+    scissor->xform[5] = (y0 + y1) * 0.5f;
+    scissor->extent[0] = (x1 - x0) * 0.5f;
+    scissor->extent[1] = (y1 - y0) * 0.5f;
+    return true;
+}
+
+static void translate_verts(NVGvertex* verts, int count, float dx, float dy) {
+    for (int i = 0; i < count; ++i) {
+        verts[i].x += dx;
+        verts[i].y += dy;
+    }
+}
+
+static void translate_call(RenderRecording::Call* call, float dx, float dy) {
+    call->paint.xform[4] += dx;
+    call->paint.xform[5] += dy;
+    if (call->scissor.extent[0] >= 0) {
+        call->scissor.xform[4] += dx;
+        call->scissor.xform[5] += dy;
+    }
+    call->bounds[0] += dx;
+    call->bounds[1] += dy;
+    call->bounds[2] += dx;
+    call->bounds[3] += dy;
+}
+
+static void record(RecorderFrame& frame, RenderRecording::Call call,
+                   const NVGpath* paths, int npaths, const NVGvertex* verts, int nverts) {
+    auto recording = frame.recording;
+    auto dx = -frame.origin_x;
+    auto dy = -frame.origin_y;
+
+    translate_call(&call, dx, dy);
+
+    call.path_offset = (int)recording->paths.size();
+    call.path_count = npaths;
+    for (int i = 0; i < npaths; ++i) {
+        RenderRecording::Path path;
+        path.path = paths[i];
+        path.fill_offset = (int)recording->verts.size();
+        recording->verts.insert(recording->verts.end(), paths[i].fill, paths[i].fill + paths[i].nfill);
+        path.stroke_offset = (int)recording->verts.size();
+        recording->verts.insert(recording->verts.end(), paths[i].stroke, paths[i].stroke + paths[i].nstroke);
+        translate_verts(recording->verts.data() + path.fill_offset, paths[i].nfill + paths[i].nstroke, dx, dy);
+        recording->paths.push_back(path);
+    }
+
+    call.vert_offset = (int)recording->verts.size();
+    call.vert_count = nverts;
+    recording->verts.insert(recording->verts.end(), verts, verts + nverts);
+    translate_verts(recording->verts.data() + call.vert_offset, nverts, dx, dy);
+
+    recording->calls.push_back(call);
+}
+
+// Passes a call down through the frames, starting at the given level, and
+// on to the backend. Every recording on the way keeps a copy of the call
+// as it looks before the clip of its own frame is applied.
+static void emit(int level, RenderRecording::Call& call,
+                 const NVGpath* paths, int npaths, const NVGvertex* verts, int nverts) {
+    for (int i = level; i >= 0; --i) {
+        auto& frame = frames[i];
+        if (frame.recording) {
+            record(frame, call, paths, npaths, verts, nverts);
+        }
+        if (!intersect_scissor(&call.scissor, &frame.clip)) {
+            return;
+        }
+    }
+    if (!intersect_scissor(&call.scissor, &root_clip)) {
+        return;
+    }
+
+    switch (call.type) {
+        case RenderRecording::Call::FILL:
+            backend.renderFill(backend.userPtr, &call.paint, call.composite_operation, &call.scissor,
+                               call.fringe, call.bounds, paths, npaths);
+            break;
+        case RenderRecording::Call::STROKE:
+            backend.renderStroke(backend.userPtr, &call.paint, call.composite_operation, &call.scissor,
+                                 call.fringe, call.stroke_width, paths, npaths);
+            break;
+        case RenderRecording::Call::TRIANGLES:
+            backend.renderTriangles(backend.userPtr, &call.paint, call.composite_operation, &call.scissor,
+                                    verts, nverts, call.fringe);
+            break;
+    }
+}
+
+static void render_fill(void* uptr, NVGpaint* paint, NVGcompositeOperationState composite_operation, NVGscissor* scissor, float fringe, const float* bounds, const NVGpath* paths, int npaths) {
+    if (frames.empty() && root_clip.extent[0] < 0) {
+        backend.renderFill(uptr, paint, composite_operation, scissor, fringe, bounds, paths, npaths);
+        return;
+    }
+
+    RenderRecording::Call call;
+    call.type = RenderRecording::Call::FILL;
+    call.paint = *paint;
+    call.composite_operation = composite_operation;
+    call.scissor = *scissor;
+    call.fringe = fringe;
+    call.stroke_width = 0.0f;
+    memcpy(call.bounds, bounds, sizeof(call.bounds));
+    emit((int)frames.size() - 1, call, paths, npaths, NULL, 0);
+}
+
+static void render_stroke(void* uptr, NVGpaint* paint, NVGcompositeOperationState composite_operation, NVGscissor* scissor, float fringe, float stroke_width, const NVGpath* paths, int npaths) {
+    if (frames.empty() && root_clip.extent[0] < 0) {
+        backend.renderStroke(uptr, paint, composite_operation, scissor, fringe, stroke_width, paths, npaths);
+        return;
+    }
+
+    RenderRecording::Call call;
+    call.type = RenderRecording::Call::STROKE;
+    call.paint = *paint;
+    call.composite_operation = composite_operation;
+    call.scissor = *scissor;
+    call.fringe = fringe;
+    call.stroke_width = stroke_width;
+    memset(call.bounds, 0, sizeof(call.bounds));
+    emit((int)frames.size() - 1, call, paths, npaths, NULL, 0);
+}
+
+static void render_triangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState composite_operation, NVGscissor* scissor, const NVGvertex* verts, int nverts, float fringe) {
+    if (frames.empty() && root_clip.extent[0] < 0) {
+        backend.renderTriangles(uptr, paint, composite_operation, scissor, verts, nverts, fringe);
+        return;
+    }
+
+    RenderRecording::Call call;
+    call.type = RenderRecording::Call::TRIANGLES;
+    call.paint = *paint;
+    call.composite_operation = composite_operation;
+    call.scissor = *scissor;
+    call.fringe = fringe;
+    call.stroke_width = 0.0f;
+    memset(call.bounds, 0, sizeof(call.bounds));
+    emit((int)frames.size() - 1, call, NULL, 0, verts, nverts);
+}
+
+void render_recorder_init(NVGcontext* vg) {
+    context = vg;
+    auto params = nvgInternalParams(vg);
+    backend = *params;
+    params->renderFill = render_fill;
+    params->renderStroke = render_stroke;
+    params->renderTriangles = render_triangles;
+}
+
+void render_recorder_begin(RenderRecording* recording, float origin_x, float origin_y, const NVGscissor* clip) {
+    recording->clear();
+
+    RecorderFrame frame;
+    frame.recording = recording;
+    frame.origin_x = origin_x;
+    frame.origin_y = origin_y;
+    frame.clip = *clip;
+    frames.push_back(frame);
+}
+
+void render_recorder_end() {
+    frames.pop_back();
+}
+
+void render_recorder_set_clip(const NVGscissor* clip) {
+    if (clip) {
+        root_clip = *clip;
+    } else {
+        root_clip.extent[0] = -1.0f;
+        root_clip.extent[1] = -1.0f;
+    }
+}
+
+void render_recorder_replay(const RenderRecording* recording, float origin_x, float origin_y, const NVGscissor* clip) {
+    RecorderFrame frame;
+    frame.recording = NULL;
+    frame.origin_x = origin_x;
+    frame.origin_y = origin_y;
+    frame.clip = *clip;
+    frames.push_back(frame);
+
+    int level = (int)frames.size() - 1;
+    for (auto call : recording->calls) {
+        translate_call(&call, origin_x, origin_y);
+
+        // Keep the glyphs of replayed text in the font atlas for this frame
+        if (call.type == RenderRecording::Call::TRIANGLES) {
+            nvgInternalTouchFontImage(context, call.paint.image);
+        }
+
+        // The paths and vertices of a call are stored next to each other
+        auto base = call.path_count > 0 ? recording->paths[call.path_offset].fill_offset : call.vert_offset;
+        replay_verts.assign(recording->verts.begin() + base,
+                            recording->verts.begin() + call.vert_offset + call.vert_count);
+        translate_verts(replay_verts.data(), (int)replay_verts.size(), origin_x, origin_y);
+
+        replay_paths.resize(call.path_count);
+        for (int i = 0; i < call.path_count; ++i) {
+            auto& path = recording->paths[call.path_offset + i];
+            replay_paths[i] = path.path;
+            replay_paths[i].fill = replay_verts.data() + (path.fill_offset - base);
+            replay_paths[i].stroke = replay_verts.data() + (path.stroke_offset - base);
+        }
+
+        emit(level, call, replay_paths.data(), call.path_count,
+             replay_verts.data() + (call.vert_offset - base), call.vert_count);
+    }
+
+    frames.pop_back();
+}
@@ -0,0 +1,64 @@
+//
+//  render_recorder.hpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#ifndef ddui_render_recorder_hpp
+#define ddui_render_recorder_hpp
+
+#include <nanovg.h>
+#include <vector>
+
+// The render recorder sits between nanovg and the render backend. While a
+// recording is active it keeps a copy of every fill, stroke and triangles
+// call, with the vertices nanovg has already tessellated, so that the
+// calls can later be replayed without running the code that produced them.
+//
+// Recordings are stored relative to an origin, so they can be replayed
+// at a different position. Every recording and replay also has a clip:
+// the scissor that was active outside of it, which is intersected into
+// the scissor of the calls before they reach the backend.
+//
+// On top of that there is a root clip, set with render_recorder_set_clip(),
+// which applies to every call but is never recorded. It is used to keep a
+// partial redraw inside of the dirty region.
+
+struct RenderRecording {
+    struct Call {
+        enum Type {
+            FILL,
+            STROKE,
+            TRIANGLES
+        };
+        Type type;
+        NVGpaint paint;
+        NVGcompositeOperationState composite_operation;
+        NVGscissor scissor;
+        float fringe;
+        float stroke_width;
+        float bounds[4];
+        int path_offset, path_count;
+        int vert_offset, vert_count;
+    };
+    struct Path {
+        NVGpath path;
+        int fill_offset;
+        int stroke_offset;
+    };
+    std::vector<Call> calls;
+    std::vector<Path> paths;
+    std::vector<NVGvertex> verts;
+
+    void clear();
+};
+
+void render_recorder_init(NVGcontext* vg);
+void render_recorder_begin(RenderRecording* recording, float origin_x, float origin_y, const NVGscissor* clip);
+void render_recorder_end();
+void render_recorder_set_clip(const NVGscissor* clip);
+void render_recorder_replay(const RenderRecording* recording, float origin_x, float origin_y, const NVGscissor* clip);
+
+#endif
@@ -0,0 +1,223 @@
+//
+//  repaint_reasons.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "repaint_reasons.hpp"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+using namespace ddui;
+
+// Reasons are interned into a table that only grows, so a thread calling
+// repaint() finds its counters without taking a lock. Each thread keeps a
+// small cache from reason pointers to entries, and the shared map is only
+// locked when a pointer isn't in it. A pointer can be a buffer that is
+// reused for other reasons, so a cached entry only counts if its text
+// still matches.
+//
+// A call only bumps a counter and sets a flag. After each frame, the
+// thread that paints turns the flags into frame counts. Rates are taken
+// over a sliding second: the frames of the current second, plus those of
+// the second before it, weighted by how much of it is still in the window.
+struct RepaintReason {
+    std::string name;
+    std::atomic<long> num_calls;
+    std::atomic<bool> was_called;
+
+    // Only touched by the thread that paints
+    long num_frames;
+    long num_extra_passes;
+    int frame_extra_passes;
+    int last_pass;
+    int window_frames[2];
+    float frames_per_second;
+    std::chrono::steady_clock::time_point last_storm_time;
+};
+
+static const int MAX_REASONS = 4096;
+static RepaintReason* reasons[MAX_REASONS];
+static std::atomic<int> num_reasons;
+static std::mutex reasons_mutex;
+static auto& reasons_by_name = *new std::unordered_map<std::string, RepaintReason*>;
+
+struct CachedReason {
+    const char* pointer;
+    RepaintReason* reason;
+};
+static const int REASON_CACHE_SIZE = 64;
+static thread_local CachedReason reason_cache[REASON_CACHE_SIZE];
+
+static bool has_window;
+static std::chrono::steady_clock::time_point window_start;
+
+static float storm_max_frames_per_second;
+static int storm_max_extra_passes;
+static std::function<void(const RepaintStorm&)> storm_handler;
+static std::vector<RepaintStorm> storms;
+
+static RepaintReason* get_reason(const char* name) {
+    auto slot = ((uint64_t)(uintptr_t)name * 0x9E3779B97F4A7C15ull >> 32) % REASON_CACHE_SIZE;
+    auto& cached = reason_cache[slot];
+    if (cached.pointer == name && strcmp(cached.reason->name.c_str(), name) == 0) {
+        return cached.reason;
+    }
+
+    RepaintReason* reason = NULL;
+    {
+        std::lock_guard<std::mutex> lock(reasons_mutex);
+        auto it = reasons_by_name.find(name);
+        if (it != reasons_by_name.end()) {
+            reason = it->second;
+        } else {
+            auto index = num_reasons.load(std::memory_order_relaxed);
+            if (index < MAX_REASONS) {
+                reason = new RepaintReason();
+                reason->name = name;
+                reasons[index] = reason;
+                num_reasons.store(index + 1, std::memory_order_release);
+                reasons_by_name[name] = reason;
+            }
+        }
+    }
+
+    // Reasons that didn't fit in the table aren't counted
+    if (reason != NULL) {
+        cached.pointer = name;
+        cached.reason = reason;
+    }
+    return reason;
+}
+
+const char* count_repaint_reason(const char* name) {
+    if (name == NULL) {
+        return NULL;
+    }
+    auto reason = get_reason(name);
+    if (reason == NULL) {
+        return NULL;
+    }
+    reason->num_calls.fetch_add(1, std::memory_order_relaxed);
+    reason->was_called.store(true, std::memory_order_relaxed);
+    return reason->name.c_str();
+}
+
+void update_repaint_reasons(const FramePassStats& pass_stats) {
+    auto now = std::chrono::steady_clock::now();
+    if (!has_window) {
+        has_window = true;
+        window_start = now;
+    }
+
+    // Move the window along by whole seconds
+    int window_shift = 0;
+    auto elapsed = std::chrono::duration<double>(now - window_start).count();
+    if (elapsed >= 1.0) {
+        auto seconds = floor(elapsed);
+        window_shift = seconds >= 2.0 ? 2 : 1;
+        window_start += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(seconds)
+        );
+        elapsed -= seconds;
+    }
+    auto previous_weight = (float)(1.0 - elapsed);
+
+    auto count = num_reasons.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        reasons[i]->frame_extra_passes = 0;
+        reasons[i]->last_pass = -1;
+    }
+
+    // The reasons of each pass asked for the one after it. A reason
+    // that was given several times in one pass added one pass.
+    for (int pass = 0; pass < pass_stats.pass_reasons.size(); ++pass) {
+        for (auto name : pass_stats.pass_reasons[pass]) {
+            auto reason = get_reason(name);
+            if (reason != NULL && reason->last_pass != pass) {
+                reason->last_pass = pass;
+                reason->frame_extra_passes += 1;
+            }
+        }
+    }
+
+    count = num_reasons.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        auto reason = reasons[i];
+
+        if (window_shift == 2) {
+            reason->window_frames[0] = 0;
+            reason->window_frames[1] = 0;
+        } else if (window_shift == 1) {
+            reason->window_frames[0] = reason->window_frames[1];
+            reason->window_frames[1] = 0;
+        }
+
+        if (reason->was_called.exchange(false, std::memory_order_relaxed)) {
+            reason->num_frames += 1;
+            reason->window_frames[1] += 1;
+        }
+        reason->num_extra_passes += reason->frame_extra_passes;
+        reason->frames_per_second = reason->window_frames[0] * previous_weight + reason->window_frames[1];
+
+        if (!storm_handler) {
+            continue;
+        }
+        if (reason->frames_per_second <= storm_max_frames_per_second &&
+            reason->frame_extra_passes <= storm_max_extra_passes) {
+            continue;
+        }
+        if (now - reason->last_storm_time < std::chrono::seconds(1)) {
+            continue;
+        }
+        reason->last_storm_time = now;
+
+        RepaintStorm storm;
+        storm.reason = reason->name.c_str();
+        storm.frames_per_second = reason->frames_per_second;
+        storm.num_extra_passes = reason->frame_extra_passes;
+        storms.push_back(storm);
+    }
+
+    // The handler may call repaint(), or replace itself
+    if (!storms.empty()) {
+        auto handler = storm_handler;
+        for (auto& storm : storms) {
+            handler(storm);
+        }
+        storms.clear();
+    }
+}
+
+std::vector<RepaintReasonStats> ddui::get_repaint_reason_stats() {
+    std::vector<RepaintReasonStats> stats;
+
+    auto count = num_reasons.load(std::memory_order_acquire);
+    stats.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        auto reason = reasons[i];
+        RepaintReasonStats entry;
+        entry.reason = reason->name.c_str();
+        entry.num_calls = reason->num_calls.load(std::memory_order_relaxed);
+        entry.num_frames = reason->num_frames;
+        entry.num_extra_passes = reason->num_extra_passes;
+        entry.frames_per_second = reason->frames_per_second;
+        stats.push_back(entry);
+    }
+
+    return stats;
+}
+
+void ddui::set_repaint_storm_handler(float max_frames_per_second, int max_extra_passes,
+                                     std::function<void(const RepaintStorm&)> handler) {
+    storm_max_frames_per_second = max_frames_per_second;
+    storm_max_extra_passes = max_extra_passes;
+    storm_handler = std::move(handler);
+}
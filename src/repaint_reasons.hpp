@@ -0,0 +1,24 @@
+//
+//  repaint_reasons.hpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#ifndef ddui_repaint_reasons_hpp
+#define ddui_repaint_reasons_hpp
+
+#include "core.hpp"
+
+// Counts a call to repaint(). Can be called from any thread. Returns the
+// reason's own copy of its text, which is never freed, or NULL if it isn't
+// counted.
+const char* count_repaint_reason(const char* reason);
+
+// Turns the calls since the last frame into frame counts and rates, counts
+// the extra passes of the frame, and reports storms. Called by the thread
+// that paints after each frame.
+void update_repaint_reasons(const ddui::FramePassStats& pass_stats);
+
+#endif
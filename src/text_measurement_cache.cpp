@@ -0,0 +1,352 @@
+//
+//  text_measurement_cache.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "text_measurement_cache.hpp"
+#include "profiling.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+
+using namespace ddui;
+
+// Views measure the same labels with the same font frame after frame, and
+// nanovg decodes the string and looks up every glyph each time. Results
+// are kept in a table of entries, chained into hash buckets and into a
+// list from most to least recently used. The table is allocated up front,
+// and once it is full the least recently used entry is reused for the next
+// miss, so a miss only allocates when a string or glyph list outgrows the
+// entry it lands in. A hash is only a hint: entries are compared in full.
+//
+// A plain LRU keeps nothing when more strings are measured in a cycle than
+// fit, like a long document measured line by line every frame. So once the
+// cache is full, a miss only takes the place of the least recently used
+// entry if its string has been looked up more often lately. Lookups are
+// counted by hash in a table of small counters, which are halved every so
+// often, so the counts follow what is measured now.
+//
+// Measurements are taken at the origin, which is where views measure.
+// Others, and long strings that are unlikely to be measured again, go
+// straight to nanovg. Adding a font or a fallback font can change how any
+// string measures, so it empties the cache.
+enum Kind {
+    BOUNDS,
+    GLYPH_POSITIONS
+};
+
+struct CachedGlyph {
+    int offset;
+    float x, minx, maxx;
+};
+
+struct Entry {
+    uint64_t hash;
+    Kind kind;
+    NVGtextState state;
+    std::string string;
+
+    // BOUNDS
+    float advance;
+    float bounds[4];
+
+    // GLYPH_POSITIONS. When fewer than max_positions glyphs were found,
+    // the positions are those of the whole string.
+    int max_positions;
+    std::vector<CachedGlyph> glyphs;
+
+    // Indices into entries, or -1
+    int prev, next;
+    int next_in_bucket;
+};
+
+static const int MAX_CACHED_LENGTH = 256;
+
+static const int MAX_FREQUENCY = 15;
+
+static int capacity = 4096;
+static int font_generation = -1;
+static std::vector<Entry> entries;
+static std::vector<int> buckets;
+static std::vector<unsigned char> frequencies;
+static int num_counted_lookups;
+static int num_entries;
+static int most_recent = -1;
+static int least_recent = -1;
+static TextMeasurementCacheStats stats;
+
+static void clear_entries() {
+    num_entries = 0;
+    most_recent = -1;
+    least_recent = -1;
+    std::fill(buckets.begin(), buckets.end(), -1);
+}
+
+static void allocate_entries() {
+    int num_buckets = 1;
+    while (num_buckets < 2 * capacity) {
+        num_buckets *= 2;
+    }
+    entries.clear();
+    entries.shrink_to_fit();
+    entries.resize(capacity);
+    buckets.assign(capacity > 0 ? num_buckets : 0, -1);
+    frequencies.assign(capacity > 0 ? num_buckets : 0, 0);
+    num_counted_lookups = 0;
+    clear_entries();
+}
+
+static uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+    auto bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t hash_key(Kind kind, const NVGtextState& state, const char* string, size_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = hash_bytes(hash, &kind, sizeof(kind));
+    hash = hash_bytes(hash, &state.fontId, sizeof(state.fontId));
+    hash = hash_bytes(hash, &state.fontSize, sizeof(state.fontSize));
+    hash = hash_bytes(hash, &state.letterSpacing, sizeof(state.letterSpacing));
+    hash = hash_bytes(hash, &state.lineHeight, sizeof(state.lineHeight));
+    hash = hash_bytes(hash, &state.fontBlur, sizeof(state.fontBlur));
+    hash = hash_bytes(hash, &state.textAlign, sizeof(state.textAlign));
+    hash = hash_bytes(hash, &state.scale, sizeof(state.scale));
+    return hash_bytes(hash, string, length);
+}
+
+static bool matches(const Entry& entry, uint64_t hash, Kind kind, const NVGtextState& state,
+                    const char* string, size_t length) {
+    return (entry.hash == hash &&
+            entry.kind == kind &&
+            entry.state.fontId == state.fontId &&
+            entry.state.fontSize == state.fontSize &&
+            entry.state.letterSpacing == state.letterSpacing &&
+            entry.state.lineHeight == state.lineHeight &&
+            entry.state.fontBlur == state.fontBlur &&
+            entry.state.textAlign == state.textAlign &&
+            entry.state.scale == state.scale &&
+            entry.string.size() == length &&
+            memcmp(entry.string.data(), string, length) == 0);
+}
+
+static int* get_bucket(uint64_t hash) {
+    return &buckets[hash & (buckets.size() - 1)];
+}
+
+static void unlink_from_list(int index) {
+    auto& entry = entries[index];
+    if (entry.prev != -1) {
+        entries[entry.prev].next = entry.next;
+    } else {
+        most_recent = entry.next;
+    }
+    if (entry.next != -1) {
+        entries[entry.next].prev = entry.prev;
+    } else {
+        least_recent = entry.prev;
+    }
+}
+
+static void push_to_front(int index) {
+    auto& entry = entries[index];
+    entry.prev = -1;
+    entry.next = most_recent;
+    if (most_recent != -1) {
+        entries[most_recent].prev = index;
+    } else {
+        least_recent = index;
+    }
+    most_recent = index;
+}
+
+static void unlink_from_bucket(int index) {
+    auto link = get_bucket(entries[index].hash);
+    while (*link != index) {
+        link = &entries[*link].next_in_bucket;
+    }
+    *link = entries[index].next_in_bucket;
+}
+
+// The bucket bits are the low bits of the hash, so counters are picked by
+// the high ones
+static unsigned char* get_frequency(uint64_t hash) {
+    return &frequencies[(hash >> 32) & (frequencies.size() - 1)];
+}
+
+static void count_lookup(uint64_t hash) {
+    auto frequency = get_frequency(hash);
+    if (*frequency < MAX_FREQUENCY) {
+        *frequency += 1;
+    }
+    if (++num_counted_lookups >= 10 * capacity) {
+        num_counted_lookups = 0;
+        for (auto& count : frequencies) {
+            count /= 2;
+        }
+    }
+}
+
+// Returns the entry for the key, or NULL. Found entries become the most
+// recently used.
+static Entry* find_entry(uint64_t hash, Kind kind, const NVGtextState& state, const char* string, size_t length) {
+    if (capacity <= 0) {
+        return NULL;
+    }
+    count_lookup(hash);
+    for (auto index = *get_bucket(hash); index != -1; index = entries[index].next_in_bucket) {
+        if (matches(entries[index], hash, kind, state, string, length)) {
+            if (index != most_recent) {
+                unlink_from_list(index);
+                push_to_front(index);
+            }
+            return &entries[index];
+        }
+    }
+    return NULL;
+}
+
+// Returns a new entry for the key to be filled in, reusing the least
+// recently used entry if the cache is full, or NULL if caching is off or
+// the key isn't looked up more often than that entry.
+static Entry* insert_entry(uint64_t hash, Kind kind, const NVGtextState& state, const char* string, size_t length) {
+    if (capacity <= 0) {
+        return NULL;
+    }
+
+    int index;
+    if (num_entries < capacity) {
+        index = num_entries++;
+    } else {
+        index = least_recent;
+        if (*get_frequency(hash) <= *get_frequency(entries[index].hash)) {
+            return NULL;
+        }
+        unlink_from_list(index);
+        unlink_from_bucket(index);
+        stats.num_evictions += 1;
+    }
+    push_to_front(index);
+
+    auto& entry = entries[index];
+    entry.hash = hash;
+    entry.kind = kind;
+    entry.state = state;
+    entry.string.assign(string, length);
+
+    auto bucket = get_bucket(hash);
+    entry.next_in_bucket = *bucket;
+    *bucket = index;
+    return &entry;
+}
+
+static bool get_text_state(NVGcontext* vg, NVGtextState* state) {
+    if (entries.size() != capacity) {
+        allocate_entries();
+    }
+    nvgInternalTextState(vg, state);
+    if (state->fontGeneration != font_generation) {
+        font_generation = state->fontGeneration;
+        clear_entries();
+    }
+    return state->fontId != -1;
+}
+
+float cached_text_bounds(NVGcontext* vg, const char* string, const char* end, float* bounds) {
+    auto length = end ? (size_t)(end - string) : strlen(string);
+    NVGtextState state;
+    if (length > MAX_CACHED_LENGTH || !get_text_state(vg, &state)) {
+        return nvgTextBounds(vg, 0, 0, string, string + length, bounds);
+    }
+
+    auto hash = hash_key(BOUNDS, state, string, length);
+    if (auto entry = find_entry(hash, BOUNDS, state, string, length)) {
+        stats.num_hits += 1;
+        if (bounds) {
+            memcpy(bounds, entry->bounds, sizeof(entry->bounds));
+        }
+        return entry->advance;
+    }
+
+    DDUI_PROFILE_SCOPE("cached_text_bounds miss");
+    stats.num_misses += 1;
+    float measured_bounds[4];
+    auto advance = nvgTextBounds(vg, 0, 0, string, string + length, measured_bounds);
+    if (bounds) {
+        memcpy(bounds, measured_bounds, sizeof(measured_bounds));
+    }
+
+    if (auto entry = insert_entry(hash, BOUNDS, state, string, length)) {
+        entry->advance = advance;
+        memcpy(entry->bounds, measured_bounds, sizeof(measured_bounds));
+        entry->glyphs.clear();
+    }
+    return advance;
+}
+
+int cached_text_glyph_positions(NVGcontext* vg, const char* string, const char* end,
+                                GlyphPosition* positions, int max_positions) {
+    auto length = end ? (size_t)(end - string) : strlen(string);
+    NVGtextState state;
+    if (length > MAX_CACHED_LENGTH || max_positions <= 0 || !get_text_state(vg, &state)) {
+        return nvgTextGlyphPositions(vg, 0, 0, string, string + length, (NVGglyphPosition*)positions, max_positions);
+    }
+
+    // An entry serves any request for at most as many glyphs as it holds,
+    // or for any number when it holds the whole string
+    auto hash = hash_key(GLYPH_POSITIONS, state, string, length);
+    auto entry = find_entry(hash, GLYPH_POSITIONS, state, string, length);
+    if (entry && (entry->glyphs.size() < entry->max_positions || max_positions <= entry->glyphs.size())) {
+        stats.num_hits += 1;
+        auto count = std::min((int)entry->glyphs.size(), max_positions);
+        for (int i = 0; i < count; ++i) {
+            auto& glyph = entry->glyphs[i];
+            positions[i].str = string + glyph.offset;
+            positions[i].x = glyph.x;
+            positions[i].minx = glyph.minx;
+            positions[i].maxx = glyph.maxx;
+        }
+        return count;
+    }
+
+    DDUI_PROFILE_SCOPE("cached_text_glyph_positions miss");
+    stats.num_misses += 1;
+    auto count = nvgTextGlyphPositions(vg, 0, 0, string, string + length, (NVGglyphPosition*)positions, max_positions);
+
+    if (!entry) {
+        entry = insert_entry(hash, GLYPH_POSITIONS, state, string, length);
+    }
+    if (entry) {
+        entry->max_positions = max_positions;
+        entry->glyphs.resize(count);
+        for (int i = 0; i < count; ++i) {
+            auto& glyph = entry->glyphs[i];
+            glyph.offset = (int)(positions[i].str - string);
+            glyph.x = positions[i].x;
+            glyph.minx = positions[i].minx;
+            glyph.maxx = positions[i].maxx;
+        }
+    }
+    return count;
+}
+
+const TextMeasurementCacheStats& ddui::get_text_measurement_cache_stats() {
+    stats.num_entries = num_entries;
+    stats.capacity = capacity;
+    auto num_lookups = stats.num_hits + stats.num_misses;
+    stats.hit_rate = num_lookups > 0 ? (float)stats.num_hits / num_lookups : 0.0f;
+    return stats;
+}
+
+void ddui::set_text_measurement_cache_capacity(int new_capacity) {
+    capacity = std::max(new_capacity, 0);
+    allocate_entries();
+}
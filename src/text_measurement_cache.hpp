@@ -0,0 +1,21 @@
+//
+//  text_measurement_cache.hpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#ifndef ddui_text_measurement_cache_hpp
+#define ddui_text_measurement_cache_hpp
+
+#include "core.hpp"
+#include <nanovg.h>
+
+// Measure a string at the origin with the current text state of vg, going
+// through the cache. Only called by the thread that paints.
+float cached_text_bounds(NVGcontext* vg, const char* string, const char* end, float* bounds);
+int cached_text_glyph_positions(NVGcontext* vg, const char* string, const char* end,
+                                ddui::GlyphPosition* positions, int max_positions);
+
+#endif
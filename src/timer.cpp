@@ -7,25 +7,27 @@
 //
 
 #include "core.hpp"
+#include "profiling.hpp"
 #include <chrono>
 #include <thread>
 #include <vector>
+#include <unordered_map>
 #include <mutex>
 #include <condition_variable>
 
-static int schedule_timer(std::function<void()> callback, long duration_in_ms, bool repeat);
+static int schedule_timer(std::function<void()> callback, long duration_in_ms, long leeway_in_ms, bool repeat);
 static void clear_timer(int timer_id);
 
-int ddui::timer::set_timeout(std::function<void()> callback, long time_in_ms) {
-    return schedule_timer(std::move(callback), time_in_ms, false);
+int ddui::timer::set_timeout(std::function<void()> callback, long time_in_ms, long leeway_in_ms) {
+    return schedule_timer(std::move(callback), time_in_ms, leeway_in_ms, false);
 }
 
 void ddui::timer::clear_timeout(int timeout_id) {
     clear_timer(timeout_id);
 }
 
-int ddui::timer::set_interval(std::function<void()> callback, long time_in_ms) {
-    return schedule_timer(std::move(callback), time_in_ms, true);
+int ddui::timer::set_interval(std::function<void()> callback, long time_in_ms, long leeway_in_ms) {
+    return schedule_timer(std::move(callback), time_in_ms, leeway_in_ms, true);
 }
 
 void ddui::timer::clear_interval(int interval_id) {
@@ -39,22 +41,56 @@ void ddui::timer::clear_interval(int interval_id) {
 
 
 
+// Timers live in slots that are reused once a timer is done, and are
+// ordered by two indexed min-heaps: one on the time they become due, and
+// one on their deadline, which is the due time plus the leeway. Each slot
+// knows its position in both heaps, so a timer can be taken out of the
+// middle of them without searching for it. Timer ids map to slots through
+// a hash map, so clearing a timer that has already fired is harmless.
+//
+// The thread sleeps until the earliest deadline, and then fires every
+// timer that is due by then in one set_immediate, so timers with
+// overlapping windows share a wake-up and a frame.
 struct Timer {
     int id;
     std::function<void()> callback;
     std::chrono::high_resolution_clock::duration duration;
-    std::chrono::high_resolution_clock::time_point due_time;
+    std::chrono::high_resolution_clock::duration leeway;
     bool repeat;
-    bool erase;
+    int due_index;
+    int deadline_index;
+};
+
+struct HeapEntry {
+    std::chrono::high_resolution_clock::time_point time;
+    int slot;
+};
+
+struct TimerHeap {
+    std::vector<HeapEntry> entries;
+    int Timer::* index;
 };
 
 static void run_thread();
+static void dispatch_due_timers(std::chrono::high_resolution_clock::time_point current_time);
+static void fire_callbacks(std::vector<std::function<void()>> callbacks);
+static void heap_push(TimerHeap& heap, int slot, std::chrono::high_resolution_clock::time_point time);
+static void heap_remove(TimerHeap& heap, int heap_index);
+static void heap_sift_up(TimerHeap& heap, int heap_index);
+static void heap_sift_down(TimerHeap& heap, int heap_index);
+static void free_timer(int slot);
 
 static std::mutex* mutex;
 static std::condition_variable* condition_variable;
-static std::vector<Timer> timers;
+
+// Never destroyed, as the timer thread is still running at exit
+static auto& timers = *new std::vector<Timer>;
+static auto& free_slots = *new std::vector<int>;
+static auto& due_heap = *new TimerHeap { {}, &Timer::due_index };
+static auto& deadline_heap = *new TimerHeap { {}, &Timer::deadline_index };
+static auto& slot_of_timer = *new std::unordered_map<int, int>;
 static int next_timer_id;
-static std::chrono::high_resolution_clock::time_point thread_wake_time;
+static std::function<void()> event_loop_wake_proc;
 
 void timer_init() {
     next_timer_id = 1;
@@ -63,81 +99,221 @@ void timer_init() {
     std::thread(run_thread).detach();
 }
 
-void run_thread() {
-    while (true) {
+void timer_use_event_loop(std::function<void()> wake_proc) {
+    std::unique_lock<std::mutex> lock(*mutex);
+    event_loop_wake_proc = std::move(wake_proc);
 
-        std::unique_lock<std::mutex> lock(*mutex);
-        auto current_time = std::chrono::high_resolution_clock::now();
-
-        // Call all callbacks that are due
-        for (auto& timer : timers) {
-            if (timer.due_time <= current_time) {
-                if (timer.repeat) {
-                    ddui::set_immediate(timer.callback);
-                    timer.due_time = timer.due_time + timer.duration;
-                } else {
-                    ddui::set_immediate(std::move(timer.callback));
-                    timer.erase = true;
-                }
-            }
-        }
+    // Let the thread see that it's no longer needed
+    condition_variable->notify_one();
+}
 
-        // Erase timeouts
-        for (int i = timers.size() - 1; i >= 0; --i) {
-            if (timers[i].erase) {
-                timers.erase(timers.begin() + i);
-            }
-        }
+bool timer_get_next_deadline(std::chrono::high_resolution_clock::time_point* deadline) {
+    std::unique_lock<std::mutex> lock(*mutex);
+    if (deadline_heap.entries.empty()) {
+        return false;
+    }
+    *deadline = deadline_heap.entries[0].time;
+    return true;
+}
+
+void timer_dispatch() {
+    std::unique_lock<std::mutex> lock(*mutex);
+    dispatch_due_timers(std::chrono::high_resolution_clock::now());
+}
+
+void run_thread() {
+    std::unique_lock<std::mutex> lock(*mutex);
+    while (!event_loop_wake_proc) {
+
+        dispatch_due_timers(std::chrono::high_resolution_clock::now());
 
         // No timers left? Sleep
-        if (timers.empty()) {
+        if (deadline_heap.entries.empty()) {
             condition_variable->wait(lock);
             continue;
         }
 
-        // Determine next wake time
-        thread_wake_time = timers.front().due_time;
-        for (auto& timer : timers) {
-            if (thread_wake_time > timer.due_time) {
-                thread_wake_time = timer.due_time;
+        // Sleep until the next deadline, or until a timer
+        // with an earlier deadline is scheduled
+        auto wake_time = deadline_heap.entries[0].time;
+        condition_variable->wait_until(lock, wake_time);
+
+    }
+}
+
+// Expects mutex to be locked
+void dispatch_due_timers(std::chrono::high_resolution_clock::time_point current_time) {
+
+    // Once a deadline has passed, call all callbacks that are due
+    if (!deadline_heap.entries.empty() && deadline_heap.entries[0].time <= current_time) {
+        std::vector<std::function<void()>> callbacks;
+        while (!due_heap.entries.empty() && due_heap.entries[0].time <= current_time) {
+            auto slot = due_heap.entries[0].slot;
+            auto& timer = timers[slot];
+            if (timer.repeat) {
+                callbacks.push_back(timer.callback);
+
+                // Skip the ticks we've fallen behind on
+                auto due_time = due_heap.entries[0].time + timer.duration;
+                if (due_time <= current_time) {
+                    due_time = current_time + timer.duration;
+                }
+                due_heap.entries[0].time = due_time;
+                heap_sift_down(due_heap, 0);
+                deadline_heap.entries[timer.deadline_index].time = due_time + timer.leeway;
+                heap_sift_down(deadline_heap, timer.deadline_index);
+            } else {
+                callbacks.push_back(std::move(timer.callback));
+                heap_remove(due_heap, timer.due_index);
+                heap_remove(deadline_heap, timer.deadline_index);
+                free_timer(slot);
             }
         }
+        fire_callbacks(std::move(callbacks));
+    }
+}
 
-        // Convert to duration and sleep
-        auto sleep_duration = thread_wake_time - current_time;
-        condition_variable->wait_for(lock, sleep_duration);
-
+void fire_callbacks(std::vector<std::function<void()>> callbacks) {
+    if (callbacks.size() == 1) {
+        ddui::set_immediate(std::move(callbacks[0]));
+        return;
     }
+
+    ddui::set_immediate([callbacks = std::move(callbacks)]() {
+        #ifdef DDUI_PROFILING_ON
+            profiling::num_timer_frames_saved += (int)callbacks.size() - 1;
+        #endif
+        for (auto& callback : callbacks) {
+            callback();
+        }
+    });
 }
 
-int schedule_timer(std::function<void()> callback, long duration_in_ms, bool repeat) {
+int schedule_timer(std::function<void()> callback, long duration_in_ms, long leeway_in_ms, bool repeat) {
     std::unique_lock<std::mutex> lock(*mutex);
 
-    bool thread_is_idle = timers.empty();
+    // An interval of zero would keep the thread from ever sleeping
+    if (repeat && duration_in_ms < 1) {
+        duration_in_ms = 1;
+    }
+    if (leeway_in_ms < 0) {
+        leeway_in_ms = 0;
+    }
+
+    int slot;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        slot = (int)timers.size();
+        timers.emplace_back();
+    }
 
-    Timer timer;
+    auto& timer = timers[slot];
     timer.id = next_timer_id++;
     timer.callback = std::move(callback);
     timer.duration = std::chrono::milliseconds(duration_in_ms);
-    timer.due_time = std::chrono::high_resolution_clock::now() + timer.duration;
+    timer.leeway = std::chrono::milliseconds(leeway_in_ms);
     timer.repeat = repeat;
-    timer.erase = false;
-    timers.push_back(std::move(timer));
+    slot_of_timer[timer.id] = slot;
 
-    if (thread_is_idle || timer.due_time < thread_wake_time) {
-        condition_variable->notify_one();
+    auto due_time = std::chrono::high_resolution_clock::now() + timer.duration;
+    heap_push(due_heap, slot, due_time);
+    heap_push(deadline_heap, slot, due_time + timer.leeway);
+
+    // Wake the thread if this is the new earliest deadline
+    if (timer.deadline_index == 0) {
+        if (event_loop_wake_proc) {
+            event_loop_wake_proc();
+        } else {
+            condition_variable->notify_one();
+        }
     }
-    
-    return timers.back().id;
+
+    return timer.id;
 }
 
 void clear_timer(int timer_id) {
     std::unique_lock<std::mutex> lock(*mutex);
 
-    for (int i = 0; i < timers.size(); ++i) {
-        if (timers[i].id == timer_id) {
-            timers.erase(timers.begin() + i);
+    auto it = slot_of_timer.find(timer_id);
+    if (it == slot_of_timer.end()) {
+        return;
+    }
+
+    auto slot = it->second;
+    heap_remove(due_heap, timers[slot].due_index);
+    heap_remove(deadline_heap, timers[slot].deadline_index);
+    free_timer(slot);
+}
+
+void free_timer(int slot) {
+    auto& timer = timers[slot];
+    slot_of_timer.erase(timer.id);
+    timer.callback = nullptr;
+    timer.due_index = -1;
+    timer.deadline_index = -1;
+    free_slots.push_back(slot);
+}
+
+void heap_push(TimerHeap& heap, int slot, std::chrono::high_resolution_clock::time_point time) {
+    HeapEntry entry;
+    entry.time = time;
+    entry.slot = slot;
+    heap.entries.push_back(entry);
+    timers[slot].*heap.index = (int)heap.entries.size() - 1;
+    heap_sift_up(heap, (int)heap.entries.size() - 1);
+}
+
+void heap_remove(TimerHeap& heap, int heap_index) {
+    auto& entries = heap.entries;
+    auto last = (int)entries.size() - 1;
+    if (heap_index != last) {
+        entries[heap_index] = entries[last];
+        timers[entries[heap_index].slot].*heap.index = heap_index;
+    }
+    entries.pop_back();
+    if (heap_index < (int)entries.size()) {
+        heap_sift_up(heap, heap_index);
+        heap_sift_down(heap, heap_index);
+    }
+}
+
+void heap_sift_up(TimerHeap& heap, int heap_index) {
+    auto& entries = heap.entries;
+    auto entry = entries[heap_index];
+    while (heap_index > 0) {
+        auto parent = (heap_index - 1) / 2;
+        if (entries[parent].time <= entry.time) {
+            break;
+        }
+        entries[heap_index] = entries[parent];
+        timers[entries[heap_index].slot].*heap.index = heap_index;
+        heap_index = parent;
+    }
+    entries[heap_index] = entry;
+    timers[entry.slot].*heap.index = heap_index;
+}
+
+void heap_sift_down(TimerHeap& heap, int heap_index) {
+    auto& entries = heap.entries;
+    auto entry = entries[heap_index];
+    auto size = (int)entries.size();
+    while (true) {
+        auto child = 2 * heap_index + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && entries[child + 1].time < entries[child].time) {
+            child += 1;
+        }
+        if (entry.time <= entries[child].time) {
             break;
         }
+        entries[heap_index] = entries[child];
+        timers[entries[heap_index].slot].*heap.index = heap_index;
+        heap_index = child;
     }
+    entries[heap_index] = entry;
+    timers[entry.slot].*heap.index = heap_index;
 }
@@ -9,6 +9,17 @@
 #ifndef ddui_timer_hpp
 #define ddui_timer_hpp
 
+#include <chrono>
+#include <functional>
+
 void timer_init();
 
+// Hands the timers over from the timer thread to an event loop on the UI
+// thread. The loop waits for the next deadline itself and then calls
+// timer_dispatch(). wake_proc is called, from any thread, whenever a timer
+// is scheduled with an earlier deadline than the ones before it.
+void timer_use_event_loop(std::function<void()> wake_proc);
+bool timer_get_next_deadline(std::chrono::high_resolution_clock::time_point* deadline);
+void timer_dispatch();
+
 #endif
@@ -8,6 +8,7 @@
 
 #include "caret_flicker.hpp"
 #include <ddui/core>
+#include <algorithm>
 
 namespace caret_flicker {
 
@@ -15,9 +16,12 @@ using namespace ddui;
 
 static bool phase;
 static int interval_id = -1;
+static bool has_caret_rect;
+static float caret_rect[4];
 
 static constexpr auto FLICKER_RATE = 1.5;
 static constexpr auto FLICKER_TIME = (long)(1000.0 / FLICKER_RATE);
+static constexpr auto FLICKER_LEEWAY = 50l;
 
 bool get_phase() {
     if (interval_id == -1) {
@@ -32,7 +36,26 @@ void reset_phase() {
     phase = true;
     interval_id = timer::set_interval([]() {
         phase = !phase;
-    }, FLICKER_TIME);
+        if (has_caret_rect) {
+            repaint("caret_flicker", caret_rect[0], caret_rect[1],
+                    caret_rect[2] - caret_rect[0], caret_rect[3] - caret_rect[1]);
+            has_caret_rect = false;
+        }
+    }, FLICKER_TIME, FLICKER_LEEWAY);
+}
+
+void set_caret_rect(float x, float y, float width, float height) {
+    float xs[4], ys[4];
+    to_global_position(&xs[0], &ys[0], x, y);
+    to_global_position(&xs[1], &ys[1], x + width, y);
+    to_global_position(&xs[2], &ys[2], x, y + height);
+    to_global_position(&xs[3], &ys[3], x + width, y + height);
+
+    caret_rect[0] = std::min(std::min(xs[0], xs[1]), std::min(xs[2], xs[3]));
+    caret_rect[1] = std::min(std::min(ys[0], ys[1]), std::min(ys[2], ys[3]));
+    caret_rect[2] = std::max(std::max(xs[0], xs[1]), std::max(xs[2], xs[3]));
+    caret_rect[3] = std::max(std::max(ys[0], ys[1]), std::max(ys[2], ys[3]));
+    has_caret_rect = true;
 }
 
 }
@@ -14,6 +14,10 @@ namespace caret_flicker {
 bool get_phase();
 void reset_phase();
 
+// Tells the flicker where the caret was drawn in the current view, so
+// that it only repaints that part of the window when the phase changes.
+void set_caret_rect(float x, float y, float width, float height);
+
 }
 
 #endif
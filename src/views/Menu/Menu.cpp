@@ -7,6 +7,7 @@
 //
 
 #include "Menu.hpp"
+#include <ddui/profiling>
 
 Menu::Menu(State& state) : state(state) {
 
@@ -219,6 +220,7 @@ Menu& Menu::render() {
 }
 
 void Menu::lay_out_menus() {
+    DDUI_PROFILE_SCOPE("Menu::lay_out_menus");
 
     auto num_opened_menus = state.opened_menu_stack.size();
 
@@ -0,0 +1,222 @@
+//
+//  PerfHud.cpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#include "PerfHud.hpp"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+namespace PerfHud {
+
+using namespace ddui;
+
+// Frames are sampled into a fixed ring, so keeping the HUD around
+// doesn't allocate. A sample is taken the first time update() runs
+// after a frame has been drawn, which is in the first pass of the next.
+struct Sample {
+    float duration_ms;
+    int num_passes;
+    int num_set_immediates;
+};
+
+constexpr int NUM_SAMPLES = 240;
+constexpr float WIDTH = 260;
+constexpr float MARGIN = 8;
+constexpr float PADDING = 8;
+constexpr float GRAPH_HEIGHT = 60;
+constexpr float GRAPH_MAX_MS = 50;
+constexpr float LINE_HEIGHT = 15;
+constexpr int NUM_LINES = 4;
+
+static Sample samples[NUM_SAMPLES];
+static int next_sample;
+static int num_samples;
+static long last_frame_number;
+static float sorted_durations[NUM_SAMPLES];
+
+// Frames within 60 fps, within 30 fps, and slower
+static const Color LEVEL_COLORS[] = {
+    { 0.30f, 0.85f, 0.39f, 1.0f },
+    { 1.00f, 0.80f, 0.00f, 1.0f },
+    { 1.00f, 0.23f, 0.19f, 1.0f }
+};
+
+static bool shown;
+static Corner corner = TOP_RIGHT;
+static const char* font = "regular";
+
+static void take_sample();
+static void get_rect(float* x, float* y, float* height);
+static void draw();
+static float get_percentile(int num_sorted, float percentile);
+static int get_duration_level(float duration_ms);
+
+void update(std::function<void()> inner_update) {
+    take_sample();
+
+    // The numbers change with every frame, so the HUD is redrawn whenever
+    // only part of the window is, before anything else draws over it
+    if (shown) {
+        float x, y, height, global_x, global_y;
+        get_rect(&x, &y, &height);
+        to_global_position(&global_x, &global_y, x, y);
+        redraw_in_current_frame(global_x, global_y, WIDTH, height);
+    }
+
+    inner_update();
+    if (shown) {
+        draw();
+    }
+}
+
+void set_shown(bool should_show) {
+    if (shown != should_show) {
+        shown = should_show;
+        repaint("PerfHud::set_shown");
+    }
+}
+
+bool is_shown() {
+    return shown;
+}
+
+void set_corner(Corner new_corner) {
+    corner = new_corner;
+    if (shown) {
+        repaint("PerfHud::set_corner");
+    }
+}
+
+void set_font(const char* font_face) {
+    font = font_face;
+}
+
+void take_sample() {
+    auto& stats = get_frame_pass_stats();
+    if (stats.frame_number == last_frame_number) {
+        return;
+    }
+    last_frame_number = stats.frame_number;
+
+    auto& sample = samples[next_sample];
+    sample.duration_ms = (float)(stats.duration * 1000.0);
+    sample.num_passes = stats.num_passes;
+    sample.num_set_immediates = stats.num_set_immediates;
+
+    next_sample = (next_sample + 1) % NUM_SAMPLES;
+    if (num_samples < NUM_SAMPLES) {
+        num_samples += 1;
+    }
+}
+
+void get_rect(float* x, float* y, float* height) {
+    *height = PADDING * 3 + GRAPH_HEIGHT + LINE_HEIGHT * NUM_LINES;
+    *x = (corner == TOP_LEFT || corner == BOTTOM_LEFT) ? MARGIN : view.width - WIDTH - MARGIN;
+    *y = (corner == TOP_LEFT || corner == TOP_RIGHT) ? MARGIN : view.height - *height - MARGIN;
+}
+
+void draw() {
+    float x, y, height;
+    get_rect(&x, &y, &height);
+
+    save();
+    translate(x, y);
+
+    begin_path();
+    rounded_rect(0, 0, WIDTH, height, 4);
+    fill_color(rgba(0x000000, 0.75f));
+    fill();
+
+    // Frame time graph, oldest sample on the left. The bars are filled
+    // as one path per color, so the HUD adds little to the render stats.
+    auto graph_x = PADDING;
+    auto graph_y = PADDING;
+    auto graph_width = WIDTH - 2 * PADDING;
+    auto bar_width = graph_width / NUM_SAMPLES;
+    for (int color = 0; color < 3; ++color) {
+        begin_path();
+        for (int i = 0; i < num_samples; ++i) {
+            auto& sample = samples[(next_sample - num_samples + i + NUM_SAMPLES) % NUM_SAMPLES];
+            if (get_duration_level(sample.duration_ms) != color) {
+                continue;
+            }
+            auto bar_height = std::min(sample.duration_ms / GRAPH_MAX_MS, 1.0f) * GRAPH_HEIGHT;
+            rect(graph_x + (NUM_SAMPLES - num_samples + i) * bar_width, graph_y + GRAPH_HEIGHT - bar_height,
+                 bar_width, bar_height);
+        }
+        fill_color(LEVEL_COLORS[color]);
+        fill();
+    }
+
+    // Lines at 60 and 30 frames per second
+    for (auto line_ms : { 1000.0f / 60, 1000.0f / 30 }) {
+        auto line_y = floorf(graph_y + GRAPH_HEIGHT * (1.0f - line_ms / GRAPH_MAX_MS)) + 0.5f;
+        begin_path();
+        move_to(graph_x, line_y);
+        line_to(graph_x + graph_width, line_y);
+        stroke_width(1);
+        stroke_color(rgba(0xffffff, 0.3f));
+        stroke();
+    }
+
+    for (int i = 0; i < num_samples; ++i) {
+        sorted_durations[i] = samples[i].duration_ms;
+    }
+    std::sort(sorted_durations, sorted_durations + num_samples);
+
+    Sample last = { 0 };
+    if (num_samples > 0) {
+        last = samples[(next_sample + NUM_SAMPLES - 1) % NUM_SAMPLES];
+    }
+    auto& render_stats = get_render_stats();
+
+    char lines[NUM_LINES][128];
+    snprintf(lines[0], sizeof(lines[0]), "%.1f ms   p50 %.1f   p95 %.1f   p99 %.1f",
+             last.duration_ms,
+             get_percentile(num_samples, 0.50f),
+             get_percentile(num_samples, 0.95f),
+             get_percentile(num_samples, 0.99f));
+    snprintf(lines[1], sizeof(lines[1]), "passes %d   set_immediates %d   glyph misses %d",
+             last.num_passes, last.num_set_immediates, render_stats.num_glyph_misses);
+    snprintf(lines[2], sizeof(lines[2]), "calls %d   verts %d   fills %d convex, %d stencil",
+             render_stats.num_calls, render_stats.num_vertices,
+             render_stats.num_convex_fills, render_stats.num_stencil_fills);
+    snprintf(lines[3], sizeof(lines[3]), "uniforms %.1f KB   textures %.1f KB   text cache %.0f%%",
+             render_stats.uniform_bytes / 1024.0f, render_stats.texture_bytes / 1024.0f,
+             get_text_measurement_cache_stats().hit_rate * 100.0f);
+
+    font_face(font);
+    font_size(12);
+    text_align(align::LEFT | align::TOP);
+    fill_color(rgb(0xffffff));
+    for (int i = 0; i < NUM_LINES; ++i) {
+        text(PADDING, graph_y + GRAPH_HEIGHT + PADDING + i * LINE_HEIGHT, lines[i], NULL);
+    }
+
+    restore();
+}
+
+float get_percentile(int num_sorted, float percentile) {
+    if (num_sorted == 0) {
+        return 0;
+    }
+    auto index = (int)ceilf(percentile * num_sorted) - 1;
+    return sorted_durations[std::max(index, 0)];
+}
+
+int get_duration_level(float duration_ms) {
+    if (duration_ms <= 1000.0f / 60) {
+        return 0;
+    }
+    if (duration_ms <= 1000.0f / 30) {
+        return 1;
+    }
+    return 2;
+}
+
+}
@@ -0,0 +1,40 @@
+//
+//  PerfHud.hpp
+//  ddui
+//
+//  Created by Bartholomew Joyce on 17/10/2026.
+//  Copyright © 2026 Bartholomew Joyce All rights reserved.
+//
+
+#ifndef ddui_PerfHud_hpp
+#define ddui_PerfHud_hpp
+
+#include <ddui/core>
+#include <functional>
+
+// A heads-up display of how the last frames went: a graph of frame times,
+// their percentiles, and the passes, set_immediates and render stats of
+// the last frame. Wrap the whole app in PerfHud::update(), outside of
+// Overlay::update(), so that the HUD is drawn over everything.
+//
+// The HUD doesn't take input and never asks for a repaint, so it only
+// changes when something else draws a frame. A frame that only redraws
+// part of the window redraws the HUD along with it.
+namespace PerfHud {
+
+enum Corner {
+    TOP_LEFT,
+    TOP_RIGHT,
+    BOTTOM_LEFT,
+    BOTTOM_RIGHT
+};
+
+void update(std::function<void()> inner_update);
+void set_shown(bool shown);
+bool is_shown();
+void set_corner(Corner corner);
+void set_font(const char* font_face);
+
+}
+
+#endif
@@ -7,6 +7,7 @@
 //
 
 #include "ScrollArea.hpp"
+#include <ddui/profiling>
 
 namespace ScrollArea {
 
@@ -30,6 +31,7 @@ ScrollAreaState::ScrollAreaState() {
 }
 
 void update(ScrollAreaState* state, float inner_width, float inner_height, std::function<void()> update_inner) {
+    DDUI_PROFILE_SCOPE("ScrollArea::update");
 
     auto container_width = view.width;
     auto container_height = view.height;
@@ -228,28 +228,18 @@ static float measure_content(State* state, float total_width, float* xs, float*
 }
 
 float measure_content_height(State* state, float total_width) {
-    //TODO(Wassim): implement proper stack allocation
-    //float xs[state->content_tokens.size()];
-    //float ys[state->content_tokens.size()];
-    //float ws[state->content_tokens.size()];
-    //float hs[state->content_tokens.size()];
-    float xs[4096];
-    float ys[4096];
-    float ws[4096];
-    float hs[4096];
+    // Laid out positions of every token, sized to the content so
+    // there's no limit on the number of tokens
+    auto n = state->content_tokens.size();
+    std::vector<float> layout(4 * n);
+    auto xs = layout.data(), ys = xs + n, ws = ys + n, hs = ws + n;
     return measure_content(state, total_width, xs, ys, ws, hs);
 }
 
 void update(State* state) {
-    //TODO(Wassim): implement proper stack allocation
-    //float xs[state->content_tokens.size()];
-    //float ys[state->content_tokens.size()];
-    //float ws[state->content_tokens.size()];
-    //float hs[state->content_tokens.size()];
-    float xs[4096];
-    float ys[4096];
-    float ws[4096];
-    float hs[4096];
+    auto n = state->content_tokens.size();
+    std::vector<float> layout(4 * n);
+    auto xs = layout.data(), ys = xs + n, ws = ys + n, hs = ws + n;
     measure_content(state, view.width, xs, ys, ws, hs);
 
     text_align(align::BASELINE | align::LEFT);
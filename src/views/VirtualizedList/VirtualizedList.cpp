@@ -7,6 +7,7 @@
 //
 
 #include "VirtualizedList.hpp"
+#include <ddui/profiling>
 
 namespace VirtualizedList {
 
@@ -20,6 +21,7 @@ void update(State* state, int number_of_elements,
             std::function<float(int)> measure_element_height,
             std::function<void(int)> update_element,
             std::function<void()> update_space_below) {
+    DDUI_PROFILE_SCOPE("VirtualizedList::update");
 
     // Number of elements changed, clear measurements
     if (state->offsets.size() != number_of_elements + 1) {
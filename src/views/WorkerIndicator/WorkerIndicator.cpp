@@ -28,7 +28,7 @@ void update(Color color) {
     constexpr auto r2 = r1 - rw;
     
     if (!animation::is_animating(ANIMATION_ID)) {
-        animation::start(ANIMATION_ID);
+        animation::start(ANIMATION_ID, 1.0 / 30);
     }
     
     constexpr auto cycle_period = 0.5;